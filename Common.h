@@ -6,7 +6,11 @@
 #include <vector>
 
 // Common shorthand type names.
+using U8 = uint8_t;
+using U16 = uint16_t;
+using I32 = int32_t;
 using U32 = uint32_t;
+using U64 = uint64_t;
 using F32 = float;
 using Vector2 = glm::vec2;
 using Vector3 = glm::vec3;
@@ -93,6 +97,23 @@ namespace Math
 	static constexpr Vector3 Zero3(0.f);
 }
 
+namespace Hash
+{
+	// Starting value and multiplier for FNV-1a hashes.
+	static constexpr U64 FnvOffsetBasis = 14695981039346656037ULL;
+	static constexpr U64 FnvPrime = 1099511628211ULL;
+
+	// Mix the bytes of a 32-bit value into an FNV-1a hash.
+	inline U64 Combine(U64 hash, U32 value)
+	{
+		for (U32 i = 0; i < sizeof(value); ++i) {
+			hash ^= (value >> (i * 8U)) & 0xFFU;
+			hash *= FnvPrime;
+		}
+		return hash;
+	}
+}
+
 // Unused variables macro.
 inline void Unused(...)
 {
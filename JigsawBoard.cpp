@@ -0,0 +1,163 @@
+#include "Common.h"
+#include "JigsawBoard.h"
+#include <cassert>
+
+JigsawBoard::JigsawBoard(U32 columns, U32 rows)
+	: mColumns(columns)
+	, mRows(rows)
+	, mPieces(columns * rows)
+	, mFlattenedEdges(0)
+{
+	assert((columns != 0) && (rows != 0));
+}
+
+// Randomize tab directions and tab jitter for all interior edges.
+void JigsawBoard::Generate(const JigsawGenerator& generator, U32 seed, F32 jitterAmount)
+{
+	const F32 amount = Math::Clamp(jitterAmount, 0.f, 1.f);
+	std::mt19937 random(seed);
+	std::bernoulli_distribution outward(0.5);
+
+	// Start from flat, undeformed pieces.
+	const JigsawMesh::Permutation flat = {
+		JigsawMesh::eFLAT, JigsawMesh::eFLAT, JigsawMesh::eFLAT, JigsawMesh::eFLAT
+	};
+	for (Piece& piece : mPieces) {
+		piece.mPermutation = flat;
+		piece.mJitter = JigsawMesh::NoJitter;
+	}
+
+	// Roll tab directions; the other side of each edge gets the complement.
+	for (U32 row = 0; row < mRows; ++row) {
+		for (U32 column = 0; column < mColumns; ++column) {
+			Piece& piece = GetMutablePiece(column, row);
+			if ((column + 1) < mColumns) {
+				Piece& right = GetMutablePiece(column + 1, row);
+				piece.mPermutation.mRight = outward(random) ? JigsawMesh::eOUTWARD : JigsawMesh::eINWARD;
+				right.mPermutation.mLeft = JigsawMesh::ComplementEndType(piece.mPermutation.mRight);
+			}
+			if ((row + 1) < mRows) {
+				Piece& bottom = GetMutablePiece(column, row + 1);
+				piece.mPermutation.mBottom = outward(random) ? JigsawMesh::eOUTWARD : JigsawMesh::eINWARD;
+				bottom.mPermutation.mTop = JigsawMesh::ComplementEndType(piece.mPermutation.mBottom);
+			}
+		}
+	}
+
+	// Triangulate each permutation in use once.
+	mMeshes.clear();
+	for (const Piece& piece : mPieces) {
+		if (mMeshes.find(piece.mPermutation) == mMeshes.end()) {
+			mMeshes[piece.mPermutation].Generate(generator, piece.mPermutation);
+		}
+	}
+
+	// Now roll jitter for each interior edge.
+	Polygon2 outline;
+	mFlattenedEdges = 0;
+	for (U32 row = 0; row < mRows; ++row) {
+		for (U32 column = 0; column < mColumns; ++column) {
+			Piece& piece = GetMutablePiece(column, row);
+			if ((column + 1) < mColumns) {
+				Piece& right = GetMutablePiece(column + 1, row);
+				if (!SetEdgeJitter(generator, random, amount, piece, piece.mJitter.mRight, right, right.mJitter.mLeft, outline)) {
+					++mFlattenedEdges;
+				}
+			}
+			if ((row + 1) < mRows) {
+				Piece& bottom = GetMutablePiece(column, row + 1);
+				if (!SetEdgeJitter(generator, random, amount, piece, piece.mJitter.mBottom, bottom, bottom.mJitter.mTop, outline)) {
+					++mFlattenedEdges;
+				}
+			}
+		}
+	}
+}
+
+// Write deformed vertices for all pieces into a single vertex stream.
+void JigsawBoard::BuildVertices(const JigsawGenerator& generator, Vertices3& vertices, Indices& baseVertices) const
+{
+	// Reserve the whole stream up front.
+	U32 vertexCount = 0;
+	for (const Piece& piece : mPieces) {
+		vertexCount += JigsawMesh::CalculateMeshVertexCount(generator, piece.mPermutation);
+	}
+	vertices.clear();
+	vertices.reserve(vertexCount);
+	baseVertices.clear();
+	baseVertices.reserve(mPieces.size());
+
+	// Lay pieces out left to right, top to bottom, reusing one outline.
+	const F32 width = generator.GetWidth();
+	const F32 height = generator.GetHeight();
+	Polygon2 outline;
+	for (U32 row = 0; row < mRows; ++row) {
+		for (U32 column = 0; column < mColumns; ++column) {
+			const Piece& piece = GetPiece(column, row);
+			const Vector2 position(static_cast<F32>(column) * width, -static_cast<F32>(row) * height);
+			baseVertices.push_back(static_cast<U32>(vertices.size()));
+			JigsawMesh::GenerateOutline(generator, piece.mPermutation, piece.mJitter, outline);
+			JigsawMesh::WriteSolidVertices(outline, position, vertices);
+		}
+	}
+	assert(vertices.size() == vertexCount);
+}
+
+// Get the shared mesh for a permutation used on this board.
+const JigsawMesh& JigsawBoard::GetMesh(const JigsawMesh::Permutation& permutation) const
+{
+	const JigsawMesh::MeshMap::const_iterator found = mMeshes.find(permutation);
+	assert(found != mMeshes.end());
+	return found->second;
+}
+
+// Roll random jitter for an end with a given strength.
+JigsawMesh::EndJitter JigsawBoard::RollEndJitter(std::mt19937& random, F32 amount)
+{
+	std::uniform_real_distribution<F32> unit(-1.f, 1.f);
+	JigsawMesh::EndJitter result;
+	result.mOffset = unit(random) * MaximumOffset * amount;
+	result.mScale = 1.f + (unit(random) * MaximumScale * amount);
+	result.mSkew = unit(random) * MaximumSkew * amount;
+	return result;
+}
+
+// Check that a piece's jittered outline keeps its permutation's triangulation valid.
+bool JigsawBoard::IsPieceValid(const JigsawGenerator& generator, const Piece& piece, Polygon2& outline) const
+{
+	JigsawMesh::GenerateOutline(generator, piece.mPermutation, piece.mJitter, outline);
+	const JigsawMesh& mesh = GetMesh(piece.mPermutation);
+	return mesh.IsTriangulationValid(outline);
+}
+
+// Roll jitter for an edge shared by two pieces, rerolling and then reducing it until both pieces stay valid.
+// Whether a jitter breaks a triangulation depends on its direction as much as its size, so a few fresh rolls are
+// tried at each strength before halving it. Previously assigned edges are already valid, so falling back to no
+// jitter always succeeds.
+bool JigsawBoard::SetEdgeJitter(
+	const JigsawGenerator& generator,
+	std::mt19937& random,
+	F32 amount,
+	Piece& piece,
+	JigsawMesh::EndJitter& pieceEnd,
+	Piece& neighbour,
+	JigsawMesh::EndJitter& neighbourEnd,
+	Polygon2& outline) const
+{
+	F32 strength = amount;
+	for (U32 attempt = 0; (attempt < JitterAttempts) && (strength > 0.f); ++attempt) {
+		for (U32 roll = 0; roll < JitterRolls; ++roll) {
+			const JigsawMesh::EndJitter jitter = RollEndJitter(random, strength);
+			pieceEnd = jitter;
+			neighbourEnd = JigsawMesh::ComplementEndJitter(jitter);
+			if (IsPieceValid(generator, piece, outline) && IsPieceValid(generator, neighbour, outline)) {
+				return true;
+			}
+		}
+		strength *= 0.5f;
+	}
+
+	pieceEnd = JigsawMesh::NoEndJitter;
+	neighbourEnd = JigsawMesh::NoEndJitter;
+	return (amount <= 0.f);
+}
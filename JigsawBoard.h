@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Common.h"
+#include "JigsawGenerator.h"
+#include "JigsawMesh.h"
+#include <random>
+#include <vector>
+
+// Grid of jigsaw pieces with matching tab directions and per-edge tab jitter.
+// Pieces share one mesh per permutation; jitter only moves vertices, so each piece looks
+// unique without triangulating it separately.
+class JigsawBoard
+{
+public:
+	// Shape of a single piece on the board.
+	struct Piece
+	{
+		JigsawMesh::Permutation mPermutation;
+		JigsawMesh::Jitter mJitter;
+	};
+
+	using Pieces = std::vector<Piece>;
+
+public:
+	JigsawBoard(U32 columns, U32 rows);
+	~JigsawBoard() = default;
+
+	// Randomize tab directions and tab jitter for all interior edges, and generate the shared permutation meshes.
+	// Jitter amount is a fraction from 0 (regular tabs) to 1 (maximum variation).
+	void Generate(const JigsawGenerator& generator, U32 seed, F32 jitterAmount);
+
+	// Write deformed vertices for all pieces into a single vertex stream.
+	// Each piece's vertices start at its entry in base vertices and use its permutation mesh's index buffer.
+	void BuildVertices(const JigsawGenerator& generator, Vertices3& vertices, Indices& baseVertices) const;
+
+	// Get the shared mesh for a permutation used on this board.
+	const JigsawMesh& GetMesh(const JigsawMesh::Permutation& permutation) const;
+
+	// Get number of columns.
+	inline U32 GetColumns() const
+	{
+		return mColumns;
+	}
+
+	// Get number of rows.
+	inline U32 GetRows() const
+	{
+		return mRows;
+	}
+
+	// Get the number of interior edges whose jitter had to be dropped to keep their pieces' triangulations valid.
+	inline U32 GetFlattenedEdgeCount() const
+	{
+		return mFlattenedEdges;
+	}
+
+	// Get a piece by grid position.
+	inline const Piece& GetPiece(U32 column, U32 row) const
+	{
+		return mPieces[(row * mColumns) + column];
+	}
+
+	// Get all pieces in row-major order.
+	inline const Pieces& GetPieces() const
+	{
+		return mPieces;
+	}
+
+private:
+	// Maximum jitter at full jitter amount.
+	static constexpr F32 MaximumOffset = 0.5f;
+	static constexpr F32 MaximumScale = 0.15f;
+	static constexpr F32 MaximumSkew = 0.3f;
+
+	// Number of jitters rolled for an edge at each strength before halving it.
+	static constexpr U32 JitterRolls = 4U;
+
+	// Number of strengths tried for an edge's jitter, halving each time, before giving up on it.
+	static constexpr U32 JitterAttempts = 8U;
+
+private:
+	// Roll random jitter for an end with a given strength.
+	static JigsawMesh::EndJitter RollEndJitter(std::mt19937& random, F32 amount);
+
+	// Get a mutable piece by grid position.
+	inline Piece& GetMutablePiece(U32 column, U32 row)
+	{
+		return mPieces[(row * mColumns) + column];
+	}
+
+	// Check that a piece's jittered outline keeps its permutation's triangulation valid.
+	bool IsPieceValid(const JigsawGenerator& generator, const Piece& piece, Polygon2& outline) const;
+
+	// Roll jitter for an edge shared by two pieces, rerolling and then reducing it until both pieces stay valid.
+	// Returns false if the edge had to be left without jitter.
+	bool SetEdgeJitter(
+		const JigsawGenerator& generator,
+		std::mt19937& random,
+		F32 amount,
+		Piece& piece,
+		JigsawMesh::EndJitter& pieceEnd,
+		Piece& neighbour,
+		JigsawMesh::EndJitter& neighbourEnd,
+		Polygon2& outline) const;
+
+private:
+	U32 mColumns;
+	U32 mRows;
+	Pieces mPieces;
+	JigsawMesh::MeshMap mMeshes;
+	U32 mFlattenedEdges;
+};
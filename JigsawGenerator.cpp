@@ -0,0 +1,78 @@
+#include "Common.h"
+#include "JigsawGenerator.h"
+#include <cassert>
+
+// Compare all parameters.
+bool JigsawGenerator::Parameters::operator==(const Parameters& other) const
+{
+	return (mWidth == other.mWidth)
+		&& (mHeight == other.mHeight)
+		&& (mCircleRadius == other.mCircleRadius)
+		&& (mEndSegments == other.mEndSegments);
+}
+
+// Compare all parameters.
+bool JigsawGenerator::Parameters::operator!=(const Parameters& other) const
+{
+	return !(*this == other);
+}
+
+JigsawGenerator::JigsawGenerator()
+	: JigsawGenerator(DefaultWidth, DefaultHeight, DefaultCircleRadius)
+{
+}
+
+JigsawGenerator::JigsawGenerator(F32 width, F32 height, F32 radius, U32 endSegments)
+{
+	assert(endSegments >= MinimumEndSegments);
+	mParameters.mWidth = width;
+	mParameters.mHeight = height;
+	mParameters.mCircleRadius = radius;
+	mParameters.mEndSegments = endSegments;
+	BuildEndVertices();
+}
+
+// Set jigsaw parameters and rebuild the end vertices.
+void JigsawGenerator::SetParameters(F32 width, F32 height, F32 radius)
+{
+	mParameters.mWidth = width;
+	mParameters.mHeight = height;
+	mParameters.mCircleRadius = radius;
+	BuildEndVertices();
+}
+
+// Set the number of segments per end side and rebuild the end vertices.
+void JigsawGenerator::SetEndSegments(U32 endSegments)
+{
+	assert(endSegments >= MinimumEndSegments);
+	mParameters.mEndSegments = endSegments;
+	BuildEndVertices();
+}
+
+// Generate the unit circle vertices for the bottom jigsaw end.
+void JigsawGenerator::BuildEndVertices()
+{
+	const U32 endSegments = mParameters.mEndSegments;
+	const F32 circleRadius = mParameters.mCircleRadius;
+	mEndVertices.resize(GetEndVertexCount());
+
+	// Get the Y value for the first points so we can start at 0.f.
+	const float desiredStartY = Math::Clamp((CircleFraction - 0.5f) * 2.f, -1.f, 1.f);
+	const float startAngle = Math::ArcCosine(desiredStartY);
+	const float offsetY = circleRadius * -Math::Cosine(startAngle);
+
+	// Now build the side vertices from the right (clockwise).
+	Vertices2::iterator front = mEndVertices.begin();
+	Vertices2::reverse_iterator back = mEndVertices.rbegin();
+	for (U32 i = 0; i < endSegments; ++i, ++front, ++back) {
+		const float percent = static_cast<float>(i) / static_cast<float>(endSegments);
+		const float angle = Math::Lerp(startAngle, Math::Pi, percent);
+		const float rightX = circleRadius * Math::Sine(angle);
+		const float vertexY = (circleRadius * Math::Cosine(angle)) + offsetY;
+		*front = Vector2(rightX, vertexY);
+		*back = Vector2(-rightX, vertexY);
+	}
+
+	// Build fixed middle point.
+	*front = Vector2(0.f, -circleRadius + offsetY);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Common.h"
+
+// Class for storing the parameters and shared end vertices used to generate jigsaw meshes.
+// Each generator is independent, so different piece sizes can be generated concurrently.
+class JigsawGenerator
+{
+public:
+	// Full set of parameters that determine generated meshes.
+	struct Parameters
+	{
+		F32 mWidth;
+		F32 mHeight;
+		F32 mCircleRadius;
+		U32 mEndSegments;
+
+		bool operator==(const Parameters& other) const;
+		bool operator!=(const Parameters& other) const;
+	};
+
+public:
+	JigsawGenerator();
+	JigsawGenerator(F32 width, F32 height, F32 radius, U32 endSegments = DefaultEndSegments);
+	~JigsawGenerator() = default;
+
+	// Set jigsaw parameters and rebuild the end vertices.
+	void SetParameters(F32 width, F32 height, F32 radius);
+
+	// Set the number of segments per end side and rebuild the end vertices.
+	// Needs at least one segment, otherwise the tab collapses to a single vertex.
+	// Changes mesh topology, so meshes must be fully regenerated.
+	void SetEndSegments(U32 endSegments);
+
+	// Get all parameters.
+	inline const Parameters& GetParameters() const
+	{
+		return mParameters;
+	}
+
+	// Get piece width.
+	inline F32 GetWidth() const
+	{
+		return mParameters.mWidth;
+	}
+
+	// Get piece height.
+	inline F32 GetHeight() const
+	{
+		return mParameters.mHeight;
+	}
+
+	// Get end circle radius.
+	inline F32 GetCircleRadius() const
+	{
+		return mParameters.mCircleRadius;
+	}
+
+	// Get number of segments per end side.
+	inline U32 GetEndSegments() const
+	{
+		return mParameters.mEndSegments;
+	}
+
+	// Get number of vertices per end.
+	inline U32 GetEndVertexCount() const
+	{
+		return (mParameters.mEndSegments * 2U) + 1U;
+	}
+
+	// Get the end vertices for the bottom outward end.
+	inline const Vertices2& GetEndVertices() const
+	{
+		return mEndVertices;
+	}
+
+public:
+	// Edge piece parameters.
+	static constexpr U32 DefaultEndSegments = 5U;
+	static constexpr U32 MinimumEndSegments = 1U;
+	static constexpr F32 CircleFraction = 0.8f;
+	static constexpr F32 DefaultCircleRadius = 0.5f;
+
+	// Temporary jigsaw parameters.
+	static constexpr F32 DefaultWidth = 4.f;
+	static constexpr F32 DefaultHeight = 3.25f;
+
+private:
+	// Generate end vertices.
+	void BuildEndVertices();
+
+private:
+	// Mesh parameters.
+	Parameters mParameters;
+
+	// Cached end vertices for these parameters.
+	Vertices2 mEndVertices;
+};
@@ -1,12 +1,12 @@
 #include "Common.h"
 #include "JigsawMesh.h"
+#include "Predicates2.h"
+#include "SharedMeshRing.h"
 #include <cassert>
 #include <cmath>
 
-F32 JigsawMesh::Width = JigsawMesh::DefaultWidth;
-F32 JigsawMesh::Height = JigsawMesh::DefaultHeight;
-F32 JigsawMesh::CircleRadius = JigsawMesh::DefaultCircleRadius;
-Vertices2 JigsawMesh::mEndVertices(JigsawMesh::EndVertexCount);
+constexpr JigsawMesh::EndJitter JigsawMesh::NoEndJitter;
+constexpr JigsawMesh::Jitter JigsawMesh::NoJitter;
 
 // Next end type iteration.
 JigsawMesh::EndType JigsawMesh::NextEndType(JigsawMesh::EndType type)
@@ -23,6 +23,32 @@ JigsawMesh::EndType JigsawMesh::NextEndType(JigsawMesh::EndType type)
 	}
 }
 
+// Get the end type that fits against the given one.
+JigsawMesh::EndType JigsawMesh::ComplementEndType(EndType type)
+{
+	switch (type)
+	{
+	case eOUTWARD:
+		return eINWARD;
+	case eINWARD:
+		return eOUTWARD;
+	case eFLAT:
+	default:
+		return eFLAT;
+	}
+}
+
+// Get the jitter that fits against the given one on a neighbouring piece.
+// The neighbour walks the shared edge in the opposite direction, which mirrors offset and skew.
+JigsawMesh::EndJitter JigsawMesh::ComplementEndJitter(const EndJitter& jitter)
+{
+	EndJitter result;
+	result.mOffset = -jitter.mOffset;
+	result.mScale = jitter.mScale;
+	result.mSkew = -jitter.mSkew;
+	return result;
+}
+
 // Get the next permutation while iterating.
 // Assumes there's a valid next permutation.
 JigsawMesh::Permutation JigsawMesh::NextPermutation(const Permutation& permutation)
@@ -68,99 +94,68 @@ bool JigsawMesh::PermutationLess::operator()(const JigsawMesh::Permutation& a, c
 }
 
 // Generate the full 3D mesh for a jigsaw piece.
-void JigsawMesh::Generate(const Permutation& permutation)
+void JigsawMesh::Generate(const JigsawGenerator& generator, const Permutation& permutation)
 {
-	// Generate the face first.
-	const Mesh2 faceMesh = GenerateFace(permutation);
-	const Polygon2& polygon = faceMesh.GetPolygon();
-	const Vertices2& polygonVertices = polygon.GetVertices();
-	const U32 faceVertexCount = static_cast<U32>(polygonVertices.size());
-	const Indices& faceIndices = faceMesh.GetIndices();
-	const U32 faceIndexCount = static_cast<U32>(faceIndices.size());
+	mPermutation = permutation;
+	mParameters = generator.GetParameters();
+	mMesh.Clear();
 
-	// Calculate how many vertices and indices we need.
-	const U32 meshVertexCount = 2 * faceVertexCount;
-	const U32 meshFacesIndexCount = faceIndexCount * 2;
-	const U32 edgeQuadCount = faceVertexCount;
-	const U32 edgeIndexCount = (edgeQuadCount * 2) * Math::VerticesPerTriangle;
-	const U32 meshIndexCount = meshFacesIndexCount + edgeIndexCount;
-	mMesh.Reserve(meshVertexCount, meshIndexCount);
+	// Generate the face first.
+	const Mesh2 faceMesh = GenerateFace(generator, permutation);
+	const U32 faceVertexCount = static_cast<U32>(faceMesh.GetPolygon().GetVertices().size());
+	const U32 faceIndexCount = static_cast<U32>(faceMesh.GetIndices().size());
+	mMesh.Reserve(2 * faceVertexCount, CalculateSolidIndexCount(faceVertexCount, faceIndexCount));
+	WriteSolidMesh(faceMesh, mMesh);
+}
 
-	// Fill vertices as such: front vertices, back vertices.
-	const U32 backVertexOffset = faceVertexCount;
-	for (const Vector2& vertex : polygonVertices) {
-		const Vector3 frontVertex(vertex.x, vertex.y, FrontZ);
-		mMesh.AddVertex(frontVertex);
-	}
-	for (const Vector2& vertex : polygonVertices) {
-		const Vector3 backVertex(vertex.x, vertex.y, BackZ);
-		mMesh.AddVertex(backVertex);
+// Generate the full 3D mesh for a jigsaw piece straight into a shared mesh ring.
+bool JigsawMesh::Generate(const JigsawGenerator& generator, const Permutation& permutation, SharedMeshPublisher& publisher)
+{
+	const Mesh2 faceMesh = GenerateFace(generator, permutation);
+	const U32 faceVertexCount = static_cast<U32>(faceMesh.GetPolygon().GetVertices().size());
+	const U32 faceIndexCount = static_cast<U32>(faceMesh.GetIndices().size());
+	if (!publisher.BeginMesh(2 * faceVertexCount, CalculateSolidIndexCount(faceVertexCount, faceIndexCount))) {
+		return false;
 	}
 
-	// Now copy index buffer for faces.
-	assert((faceIndexCount % Math::VerticesPerTriangle) == 0);
-	const Indices::const_iterator indicesEnd = faceIndices.end();
-	for (Indices::const_iterator i = faceIndices.begin(); i != indicesEnd; i += Math::VerticesPerTriangle) {
-		const U32 first = *i;
-		const U32 second = *(i + 1);
-		const U32 third = *(i + 2);
-		mMesh.AddIndex(first);
-		mMesh.AddIndex(second);
-		mMesh.AddIndex(third);
-	}
-	for (Indices::const_iterator i = faceIndices.begin(); i != indicesEnd; i += Math::VerticesPerTriangle) {
-		const U32 first = *i;
-		const U32 second = *(i + 1);
-		const U32 third = *(i + 2);
+	WriteSolidMesh(faceMesh, publisher);
+	publisher.PublishMesh();
+	return true;
+}
 
-		// Back faces are in reverse triangle order.
-		mMesh.AddIndex(first);
-		mMesh.AddIndex(third);
-		mMesh.AddIndex(second);
+// Update the generated mesh for changed generator parameters.
+void JigsawMesh::Update(const JigsawGenerator& generator)
+{
+	assert(!mMesh.GetVertices().empty());
+	const JigsawGenerator::Parameters& parameters = generator.GetParameters();
+	if (parameters == mParameters) {
+		return;
 	}
 
-	// Now generate quad indices for the outer edges.
-	{
-		U32 previous = faceVertexCount - 1U;
-		for (U32 front = 0; front != faceVertexCount; previous = front, ++front) {
-			const U32 previousBack = previous + backVertexOffset;
-			const U32 back = front + backVertexOffset;
-
-			// First triangle.
-			mMesh.AddIndex(previous);
-			mMesh.AddIndex(previousBack);
-			mMesh.AddIndex(front);
-
-			// Second triangle.
-			mMesh.AddIndex(previousBack);
-			mMesh.AddIndex(back);
-			mMesh.AddIndex(front);
-		}
+	// Different end segment count changes the vertex count, so start over.
+	if (parameters.mEndSegments != mParameters.mEndSegments) {
+		Generate(generator, mPermutation);
+		return;
 	}
-}
 
-// Generate the unit circle vertices for the bottom jigsaw end.
-void JigsawMesh::BuildEndVertices()
-{
-    // Get the Y value for the first points so we can start at 0.f.
-    const float desiredStartY = Math::Clamp((CircleFraction - 0.5f) * 2.f, -1.f, 1.f);
-    const float startAngle = Math::ArcCosine(desiredStartY);
-    const float offsetY = CircleRadius * -Math::Cosine(startAngle);
-
-    // Now build the side vertices from the right (clockwise).
-	Vertices2::iterator front = mEndVertices.begin();
-	Vertices2::reverse_iterator back = mEndVertices.rbegin();
-    for (U32 i = 0; i < EndSegments; ++i, ++front, ++back) {
-        const float percent = static_cast<float>(i) / static_cast<float>(EndSegments);
-        const float angle = Math::Lerp(startAngle, Math::Pi, percent);
-        const float rightX = CircleRadius * Math::Sine(angle);
-        const float vertexY = (CircleRadius * Math::Cosine(angle)) + offsetY;
-        *front = Vector2(rightX, vertexY);
-        *back = Vector2(-rightX, vertexY);
-    }
+	// Only corners and end centers move, so the outline has the same vertex order.
+	Polygon2 outline;
+	GenerateOutline(generator, mPermutation, NoJitter, outline);
+	if (!IsTriangulationValid(outline)) {
+		Generate(generator, mPermutation);
+		return;
+	}
 
-    // Build fixed middle point.
-	*front = Vector2(0.f, -CircleRadius + offsetY);
+	// Move front and back vertices in place.
+	const Vertices2& outlineVertices = outline.GetVertices();
+	const U32 faceVertexCount = static_cast<U32>(outlineVertices.size());
+	const U32 backVertexOffset = faceVertexCount;
+	for (U32 i = 0; i < faceVertexCount; ++i) {
+		const Vector2& vertex = outlineVertices[i];
+		mMesh.SetVertex(i, Vector3(vertex.x, vertex.y, FrontZ));
+		mMesh.SetVertex(i + backVertexOffset, Vector3(vertex.x, vertex.y, BackZ));
+	}
+	mParameters = parameters;
 }
 
 // Transform a direction vector in the bottom end's space into a full end permutation's space.
@@ -183,88 +178,236 @@ Vector2 JigsawMesh::TransformToEnd(const Vector2& vector, End end, EndType type)
 }
 
 // Helper to get the middle of a given end piece.
-Vector2 JigsawMesh::GetEndCenter(End end)
+Vector2 JigsawMesh::GetEndCenter(const JigsawGenerator& generator, End end)
 {
+    const F32 width = generator.GetWidth();
+    const F32 height = generator.GetHeight();
     switch (end)
     {
     case eTOP:
-        return Vector2(0.f, 0.5f * Height);
+        return Vector2(0.f, 0.5f * height);
     case eRIGHT:
-        return Vector2(0.5f * Width, 0.f);
+        return Vector2(0.5f * width, 0.f);
     case eBOTTOM:
-        return Vector2(0.f, -0.5f * Height);
+        return Vector2(0.f, -0.5f * height);
     case eLEFT:
-        return Vector2(-0.5f * Width, 0.f);
+        return Vector2(-0.5f * width, 0.f);
     }
     assert(false);
     return Math::Zero2;
 }
 
+// Apply tab jitter to a vertex in the bottom end's space.
+// The base vertices lie on the edge, so they stay on it and the outline remains closed.
+Vector2 JigsawMesh::JitterEndVertex(const Vector2& vertex, const EndJitter& jitter, F32 circleRadius)
+{
+	const F32 skewedX = vertex.x + (jitter.mSkew * vertex.y);
+	const F32 offset = jitter.mOffset * circleRadius;
+	return Vector2(offset + (jitter.mScale * skewedX), jitter.mScale * vertex.y);
+}
+
 // Helper to write end vertices to an array of vertices.
 // Returns the iterator to the next vertex to be written.
-void JigsawMesh::WriteEndVertices(Polygon2& polygon, End end, EndType type)
+void JigsawMesh::WriteEndVertices(const JigsawGenerator& generator, Polygon2& polygon, End end, EndType type, const EndJitter& jitter)
 {
     if (type == eFLAT) {
 		return;
     }
 
-    const Vector2 endCenter = GetEndCenter(end);
-	for (const Vector2& vertex : mEndVertices)
+    const Vector2 endCenter = GetEndCenter(generator, end);
+	const F32 circleRadius = generator.GetCircleRadius();
+	for (const Vector2& vertex : generator.GetEndVertices())
 	{
-		const Vector2 offset = TransformToEnd(vertex, end, type);
+		const Vector2 jittered = JitterEndVertex(vertex, jitter, circleRadius);
+		const Vector2 offset = TransformToEnd(jittered, end, type);
 		const Vector2 result = endCenter + offset;
 		polygon.AddVertex(result);
 	}
 }
 
 // Calculate vertex count of a given jigsaw permutation.
-U32 JigsawMesh::CalculateVertexCount(const Permutation& permutation)
+U32 JigsawMesh::CalculateVertexCount(const JigsawGenerator& generator, const Permutation& permutation)
 {
+	const U32 endVertexCount = generator.GetEndVertexCount();
 	U32 count = 4U; // Four corners at least.
     if (permutation.mTop != eFLAT) {
-        count += EndVertexCount;
+        count += endVertexCount;
     }
     if (permutation.mRight != eFLAT) {
-		count += EndVertexCount;
+		count += endVertexCount;
     }
     if (permutation.mBottom != eFLAT) {
-		count += EndVertexCount;
+		count += endVertexCount;
     }
     if (permutation.mLeft != eFLAT) {
-		count += EndVertexCount;
+		count += endVertexCount;
     }
     return count;
 }
 
-// Generate the 2D jigsaw face mesh for a given permutation.
-Mesh2 JigsawMesh::GenerateFace(const Permutation& permutation)
+// Calculate number of 3D mesh vertices for a given jigsaw permutation.
+U32 JigsawMesh::CalculateMeshVertexCount(const JigsawGenerator& generator, const Permutation& permutation)
 {
-	Polygon2 polygon;
-    const U32 vertexCount = CalculateVertexCount(permutation);
+	return 2 * CalculateVertexCount(generator, permutation);
+}
+
+// Generate the 2D jigsaw outline for a given permutation and jitter.
+void JigsawMesh::GenerateOutline(const JigsawGenerator& generator, const Permutation& permutation, const Jitter& jitter, Polygon2& polygon)
+{
+	polygon.Clear();
+    const U32 vertexCount = CalculateVertexCount(generator, permutation);
 	polygon.Reserve(vertexCount);
 
     // Add top left vertex and top edge end.
-    const Vector2 topLeft(-0.5f * Width, 0.5f * Height);
+    const Vector2 topLeft(-0.5f * generator.GetWidth(), 0.5f * generator.GetHeight());
 	polygon.AddVertex(topLeft);
-	WriteEndVertices(polygon, eTOP, permutation.mTop);
+	WriteEndVertices(generator, polygon, eTOP, permutation.mTop, jitter.mTop);
 
     // Add top right and right edge end.
     const Vector2 topRight(-topLeft.x, topLeft.y);
 	polygon.AddVertex(topRight);
-    WriteEndVertices(polygon, eRIGHT, permutation.mRight);
+    WriteEndVertices(generator, polygon, eRIGHT, permutation.mRight, jitter.mRight);
 
     // Add bottom right and bottom edge end.
     const Vector2 bottomRight(topRight.x, -topRight.y);
 	polygon.AddVertex(bottomRight);
-	WriteEndVertices(polygon, eBOTTOM, permutation.mBottom);
+	WriteEndVertices(generator, polygon, eBOTTOM, permutation.mBottom, jitter.mBottom);
 
     // Add bottom left and left end.
     const Vector2 bottomLeft(topLeft.x, bottomRight.y);
 	polygon.AddVertex(bottomLeft);
-    WriteEndVertices(polygon, eLEFT, permutation.mLeft);
+    WriteEndVertices(generator, polygon, eLEFT, permutation.mLeft, jitter.mLeft);
+}
+
+// Append front and back vertices for an outline moved by a position.
+void JigsawMesh::WriteSolidVertices(const Polygon2& outline, const Vector2& position, Vertices3& output)
+{
+	const Vertices2& outlineVertices = outline.GetVertices();
+	for (const Vector2& vertex : outlineVertices) {
+		const Vector2 moved = vertex + position;
+		output.push_back(Vector3(moved.x, moved.y, FrontZ));
+	}
+	for (const Vector2& vertex : outlineVertices) {
+		const Vector2 moved = vertex + position;
+		output.push_back(Vector3(moved.x, moved.y, BackZ));
+	}
+}
+
+// Generate the 2D jigsaw face mesh for a given permutation.
+Mesh2 JigsawMesh::GenerateFace(const JigsawGenerator& generator, const Permutation& permutation)
+{
+	Polygon2 polygon;
+	GenerateOutline(generator, permutation, NoJitter, polygon);
 
     // Triangulate it.
 	Mesh2 result(polygon);
 	result.Triangulate();
 	return result;
 }
+
+// Check that every front face triangle keeps its orientation with a moved outline.
+// The outline is clockwise, so a triangle that becomes anything but clockwise has flipped or collapsed,
+// and the outline must be re-triangulated.
+bool JigsawMesh::IsTriangulationValid(const Polygon2& outline) const
+{
+	const Vertices2& outlineVertices = outline.GetVertices();
+	const Vertices3& meshVertices = mMesh.GetVertices();
+	const Indices& meshIndices = mMesh.GetIndices();
+	const U32 faceVertexCount = static_cast<U32>(outlineVertices.size());
+	assert(meshVertices.size() == (2 * faceVertexCount));
+
+	// Front face indices come first in the index buffer.
+	const U32 faceIndexCount = (faceVertexCount - Math::TriangleToVerticesOffset) * Math::VerticesPerTriangle;
+	for (U32 i = 0; i < faceIndexCount; i += Math::VerticesPerTriangle) {
+		const U32 first = meshIndices[i];
+		const U32 second = meshIndices[i + 1];
+		const U32 third = meshIndices[i + 2];
+		const I32 oldOrientation = Predicates2::Orient(
+			Vector2(meshVertices[first]),
+			Vector2(meshVertices[second]),
+			Vector2(meshVertices[third]));
+		const I32 newOrientation = Predicates2::Orient(
+			outlineVertices[first],
+			outlineVertices[second],
+			outlineVertices[third]);
+		const bool isClockwise = (newOrientation < 0);
+		if ((newOrientation != oldOrientation) && !isClockwise) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Calculate number of 3D mesh indices for a face: both faces plus a quad per outline edge.
+U32 JigsawMesh::CalculateSolidIndexCount(U32 faceVertexCount, U32 faceIndexCount)
+{
+	const U32 meshFacesIndexCount = faceIndexCount * 2;
+	const U32 edgeQuadCount = faceVertexCount;
+	const U32 edgeIndexCount = (edgeQuadCount * 2) * Math::VerticesPerTriangle;
+	return meshFacesIndexCount + edgeIndexCount;
+}
+
+// Write the solid mesh for a face to any output with Mesh3's vertex and index interface.
+// Space for the vertices and indices must already be reserved.
+template <typename MeshOutput>
+void JigsawMesh::WriteSolidMesh(const Mesh2& faceMesh, MeshOutput& output)
+{
+	const Polygon2& polygon = faceMesh.GetPolygon();
+	const Vertices2& polygonVertices = polygon.GetVertices();
+	const U32 faceVertexCount = static_cast<U32>(polygonVertices.size());
+	const Indices& faceIndices = faceMesh.GetIndices();
+	const U32 faceIndexCount = static_cast<U32>(faceIndices.size());
+
+	// Fill vertices as such: front vertices, back vertices.
+	const U32 backVertexOffset = faceVertexCount;
+	for (const Vector2& vertex : polygonVertices) {
+		const Vector3 frontVertex(vertex.x, vertex.y, FrontZ);
+		output.AddVertex(frontVertex);
+	}
+	for (const Vector2& vertex : polygonVertices) {
+		const Vector3 backVertex(vertex.x, vertex.y, BackZ);
+		output.AddVertex(backVertex);
+	}
+
+	// Now copy index buffer for faces.
+	assert((faceIndexCount % Math::VerticesPerTriangle) == 0);
+	const Indices::const_iterator indicesEnd = faceIndices.end();
+	for (Indices::const_iterator i = faceIndices.begin(); i != indicesEnd; i += Math::VerticesPerTriangle) {
+		const U32 first = *i;
+		const U32 second = *(i + 1);
+		const U32 third = *(i + 2);
+		output.AddIndex(first);
+		output.AddIndex(second);
+		output.AddIndex(third);
+	}
+	for (Indices::const_iterator i = faceIndices.begin(); i != indicesEnd; i += Math::VerticesPerTriangle) {
+		const U32 first = *i;
+		const U32 second = *(i + 1);
+		const U32 third = *(i + 2);
+
+		// Back faces are in reverse triangle order.
+		output.AddIndex(first);
+		output.AddIndex(third);
+		output.AddIndex(second);
+	}
+
+	// Now generate quad indices for the outer edges.
+	{
+		U32 previous = faceVertexCount - 1U;
+		for (U32 front = 0; front != faceVertexCount; previous = front, ++front) {
+			const U32 previousBack = previous + backVertexOffset;
+			const U32 back = front + backVertexOffset;
+
+			// First triangle.
+			output.AddIndex(previous);
+			output.AddIndex(previousBack);
+			output.AddIndex(front);
+
+			// Second triangle.
+			output.AddIndex(previousBack);
+			output.AddIndex(back);
+			output.AddIndex(front);
+		}
+	}
+}
+
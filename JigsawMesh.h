@@ -1,8 +1,12 @@
 #pragma once
 
 #include "Common.h"
+#include "JigsawGenerator.h"
 #include "Mesh2.h"
 #include "Mesh3.h"
+#include <map>
+
+class SharedMeshPublisher;
 
 // Class for storing a specific jigsaw piece permutation mesh.
 class JigsawMesh
@@ -25,9 +29,39 @@ public:
 		EndType mLeft;
 	};
 
+	// Tab deformation for a single end, applied in the bottom end's space.
+	// Neighbouring ends must use complementary jitter to fit together.
+	struct EndJitter
+	{
+		F32 mOffset; // Shift of the tab along the edge, in circle radii.
+		F32 mScale; // Tab size multiplier.
+		F32 mSkew; // Sideways lean of the tab per unit of depth.
+	};
+
+	// Tab deformation for all four ends of a piece.
+	struct Jitter
+	{
+		EndJitter mTop;
+		EndJitter mRight;
+		EndJitter mBottom;
+		EndJitter mLeft;
+	};
+
+	// Jitter that leaves a single tab undeformed.
+	static constexpr EndJitter NoEndJitter = { 0.f, 1.f, 0.f };
+
+	// Jitter that leaves all tabs undeformed.
+	static constexpr Jitter NoJitter = { NoEndJitter, NoEndJitter, NoEndJitter, NoEndJitter };
+
 	// Next end type iteration.
 	static EndType NextEndType(EndType type);
 
+	// Get the end type that fits against the given one.
+	static EndType ComplementEndType(EndType type);
+
+	// Get the jitter that fits against the given one on a neighbouring piece.
+	static EndJitter ComplementEndJitter(const EndJitter& jitter);
+
 	// Get the next permutation while iterating.
 	static Permutation NextPermutation(const Permutation& permutation);
 
@@ -37,36 +71,57 @@ public:
 		bool operator()(const Permutation& a, const Permutation& b) const;
 	};
 
+	// Meshes keyed by permutation, all generated with one generator's parameters.
+	using MeshMap = std::map<Permutation, JigsawMesh, PermutationLess>;
+
 public:
 	JigsawMesh() = default;
 	~JigsawMesh() = default;
 
-	// Generate a mesh for a certain permutation.
-	void Generate(const Permutation& permutation);
+	// Generate a mesh for a certain permutation with the given generator's parameters.
+	void Generate(const JigsawGenerator& generator, const Permutation& permutation);
+
+	// Generate a mesh for a certain permutation straight into the next slot of a shared mesh ring and publish it.
+	// Returns false if the ring has no free slot or the mesh doesn't fit one.
+	static bool Generate(const JigsawGenerator& generator, const Permutation& permutation, SharedMeshPublisher& publisher);
+
+	// Update the generated mesh for changed generator parameters.
+	// Vertex positions are moved in place when the topology and triangulation stay valid,
+	// otherwise the mesh is regenerated from scratch.
+	void Update(const JigsawGenerator& generator);
+
+	// Get the generated 3D mesh.
+	inline const Mesh3& GetMesh() const
+	{
+		return mMesh;
+	}
+
+	// Take ownership of the generated 3D mesh, leaving this one empty.
+	inline Mesh3 ReleaseMesh()
+	{
+		return std::move(mMesh);
+	}
 
 public:
-	// Set jigsaw parameters.
-	static void SetJigsawParameters(F32 width, F32 height, F32 radius);
+	// Calculate number of 3D mesh vertices for a given jigsaw permutation.
+	static U32 CalculateMeshVertexCount(const JigsawGenerator& generator, const Permutation& permutation);
 
-	// Generate end vertices.
-	static void BuildEndVertices();
+	// Generate the 2D outline for a permutation with per-end tab jitter.
+	// The vertex order doesn't depend on the jitter, so the permutation's index buffer applies to all of them.
+	static void GenerateOutline(const JigsawGenerator& generator, const Permutation& permutation, const Jitter& jitter, Polygon2& outline);
 
-private:
-	// Edge piece parameters.
-	static constexpr U32 EndSegments = 5U;
-	static constexpr U32 EndVertexCount = ((EndSegments * 2U) + 1U);
-	static constexpr F32 CircleFraction = 0.8f;
-	static constexpr F32 DefaultCircleRadius = 0.5f;
+	// Append front and back vertices for an outline moved by a position, in the same layout as generated meshes.
+	static void WriteSolidVertices(const Polygon2& outline, const Vector2& position, Vertices3& output);
+
+	// Check that the current face triangulation keeps its orientation with a moved outline.
+	bool IsTriangulationValid(const Polygon2& outline) const;
 
+private:
 	// Jigsaw parameters.
 	static constexpr F32 Depth = 1.f;
 	static constexpr F32 FrontZ = 0.5f * Depth;
 	static constexpr F32 BackZ = -0.5f * Depth;
 
-	// Temporary jigsaw parameters.
-	static constexpr F32 DefaultWidth = 4.f;
-	static constexpr F32 DefaultHeight = 3.25f;
-
 	// Helper type for transforming end.
 	enum End
 	{
@@ -80,31 +135,33 @@ private:
 	// Transform a point from bottom end space into end permutation space.
 	static Vector2 TransformToEnd(const Vector2& vector, End end, EndType type);
 
-	// Get a vertex by index for a given end permutation.
-	static Vector2 GetEndVertex(U32 index, End end, EndType type);
-
 	// Get local center coordinate for where to put an end piece.
-	static Vector2 GetEndCenter(End end);
+	static Vector2 GetEndCenter(const JigsawGenerator& generator, End end);
+
+	// Apply tab jitter to a vertex in the bottom end's space.
+	static Vector2 JitterEndVertex(const Vector2& vertex, const EndJitter& jitter, F32 circleRadius);
 
 	// Helper to write end vertices to an array of vertices.
 	// Returns the iterator to the next vertex to be written.
-	static void WriteEndVertices(Polygon2& polygon, End end, EndType type);
+	static void WriteEndVertices(const JigsawGenerator& generator, Polygon2& polygon, End end, EndType type, const EndJitter& jitter);
 
 	// Calculate number of vertices for a given jigsaw permutation.
-	static U32 CalculateVertexCount(const Permutation& permutation);
+	static U32 CalculateVertexCount(const JigsawGenerator& generator, const Permutation& permutation);
 
 	// Generate a 2D mesh for the jigsaw piece face.
-	static Mesh2 GenerateFace(const Permutation& permutation);
+	static Mesh2 GenerateFace(const JigsawGenerator& generator, const Permutation& permutation);
 
-private:
-	// Mesh parameters.
-	static F32 Width;
-	static F32 Height;
-	static F32 CircleRadius;
+	// Calculate number of 3D mesh indices for a face with the given vertex and index counts.
+	static U32 CalculateSolidIndexCount(U32 faceVertexCount, U32 faceIndexCount);
 
-	// Cached 2D mesh for this permutation.
-	static Vertices2 mEndVertices;
+	// Write front and back faces and edge quads for a face to a mesh output.
+	template <typename MeshOutput>
+	static void WriteSolidMesh(const Mesh2& faceMesh, MeshOutput& output);
 
 private:
+	// Permutation and parameters the mesh was last generated with.
+	Permutation mPermutation;
+	JigsawGenerator::Parameters mParameters;
+
 	Mesh3 mMesh;
 };
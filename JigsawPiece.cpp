@@ -1,7 +1,5 @@
 #include "JigsawPiece.h"
 
-JigsawPiece::MeshMap JigsawPiece::PermutationMeshes;
-
 JigsawPiece::JigsawPiece(const Vector2& position, const JigsawMesh::Permutation& permutation)
 	: mPosition(position)
 	, mVertexBuffer(0)
@@ -10,8 +8,8 @@ JigsawPiece::JigsawPiece(const Vector2& position, const JigsawMesh::Permutation&
 {
 }
 
-// Prepare all valid permutations.
-void JigsawPiece::GeneratePermutations()
+// Generate all valid permutations into a map owned by the caller.
+void JigsawPiece::GeneratePermutations(const JigsawGenerator& generator, JigsawMesh::MeshMap& meshes)
 {
 	const JigsawMesh::PermutationLess comparator;
 	const JigsawMesh::Permutation endPermutation = {
@@ -22,10 +20,18 @@ void JigsawPiece::GeneratePermutations()
 	};
 
 	// Completely flat box is invalid permutation, so end at it.
+	meshes.clear();
 	while (comparator(permutation, endPermutation)) {
-		JigsawMesh* mesh = new JigsawMesh();
-		mesh->Generate(permutation);
-		PermutationMeshes[permutation] = mesh;
+		meshes[permutation].Generate(generator, permutation);
 		permutation = JigsawMesh::NextPermutation(permutation);
 	}
 }
+
+// Update all permutation meshes after the generator's parameters changed.
+void JigsawPiece::UpdatePermutations(const JigsawGenerator& generator, JigsawMesh::MeshMap& meshes)
+{
+	for (JigsawMesh::MeshMap::value_type& entry : meshes) {
+		JigsawMesh& mesh = entry.second;
+		mesh.Update(generator);
+	}
+}
@@ -4,7 +4,6 @@
 #include "JigsawMesh.h"
 #include <windows.h>
 #include <gl/gl.h>
-#include <map>
 
 // Piece that stores all information for simulating and rendering a jigsaw piece.
 class JigsawPiece
@@ -14,12 +13,12 @@ public:
 	~JigsawPiece() = default;
 
 public:
-	// Prepare all valid permutations.
-	static void GeneratePermutations();
+	// Generate all valid permutations with the given generator's parameters, replacing any meshes in the map.
+	// Each generator needs its own map, so different piece sizes can be generated on different threads.
+	static void GeneratePermutations(const JigsawGenerator& generator, JigsawMesh::MeshMap& meshes);
 
-private:
-	using MeshMap = std::map<JigsawMesh::Permutation, JigsawMesh*, JigsawMesh::PermutationLess>;
-	static MeshMap PermutationMeshes;
+	// Update all permutation meshes after the generator's parameters changed.
+	static void UpdatePermutations(const JigsawGenerator& generator, JigsawMesh::MeshMap& meshes);
 
 private:
 	Vector2 mPosition;
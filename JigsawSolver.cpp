@@ -0,0 +1,801 @@
+#include "Common.h"
+#include "JigsawSolver.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace
+{
+	// Quantize a jitter value so it and its negation map to opposite integers.
+	inline I32 Quantize(F32 value, F32 step)
+	{
+		return static_cast<I32>(lroundf(value / step));
+	}
+}
+
+// Bound to references by standard containers and std::max, so they need definitions.
+constexpr U32 JigsawSolver::NoPiece;
+constexpr U64 JigsawSolver::MinimumSearchSteps;
+constexpr U64 JigsawSolver::MinimumRepairSteps;
+
+JigsawSolver::JigsawSolver(U32 threadCount)
+	: mThreadCount(threadCount)
+	, mPieces(nullptr)
+	, mColumns(0)
+	, mRows(0)
+{
+	if (mThreadCount == 0) {
+		mThreadCount = std::max(std::thread::hardware_concurrency(), 1U);
+	}
+}
+
+// Find the board dimensions and the grid position of every piece.
+bool JigsawSolver::Solve(const JigsawBoard::Pieces& pieces)
+{
+	mPieces = &pieces;
+	mSignatures.clear();
+	mLeftBuckets.clear();
+	mTopBuckets.clear();
+	mTopLeftPieces.clear();
+	mPlacement.clear();
+	mColumns = 0;
+	mRows = 0;
+
+	// Border pieces give the board dimensions: one flat top per column, one flat left per row.
+	const U32 pieceCount = static_cast<U32>(pieces.size());
+	for (const JigsawBoard::Piece& piece : pieces) {
+		mColumns += (piece.mPermutation.mTop == JigsawMesh::eFLAT) ? 1U : 0U;
+		mRows += (piece.mPermutation.mLeft == JigsawMesh::eFLAT) ? 1U : 0U;
+	}
+	if ((pieceCount == 0) || ((mColumns * mRows) != pieceCount)) {
+		return false;
+	}
+
+	// Index every piece by its left and top ends.
+	mSignatures.reserve(pieceCount);
+	for (U32 i = 0; i < pieceCount; ++i) {
+		const JigsawBoard::Piece& piece = pieces[i];
+		PieceSignature signature;
+		signature.mTop = MakeComplementSignature(piece.mPermutation.mTop, piece.mJitter.mTop);
+		signature.mRight = MakeSignature(piece.mPermutation.mRight, piece.mJitter.mRight);
+		signature.mBottom = MakeSignature(piece.mPermutation.mBottom, piece.mJitter.mBottom);
+		signature.mLeft = MakeComplementSignature(piece.mPermutation.mLeft, piece.mJitter.mLeft);
+		mSignatures.push_back(signature);
+
+		mLeftBuckets[MakeKey(signature.mLeft)].push_back(i);
+		mTopBuckets[MakeKey(signature.mTop)].push_back(i);
+		if ((piece.mPermutation.mTop == JigsawMesh::eFLAT) && (piece.mPermutation.mLeft == JigsawMesh::eFLAT)) {
+			mTopLeftPieces.push_back(i);
+		}
+	}
+
+	// Distinct tab jitter usually makes every match unique, so try the parallel solve first.
+	if (SolveParallel()) {
+		return true;
+	}
+
+	// Some edges match more than one piece, for example where an edge has no jitter.
+	// Search for an assembly; if there are too many choices to try them all, repair a greedy one instead.
+	BuildClasses();
+	bool isExhausted = false;
+	if (SolveSearch(isExhausted)) {
+		return true;
+	}
+	if (isExhausted) {
+		return false;
+	}
+	for (U32 attempt = 0; attempt < RepairAttempts; ++attempt) {
+		if (SolveRepair(attempt)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Get the signature of a piece's right or bottom end.
+JigsawSolver::EdgeSignature JigsawSolver::MakeSignature(JigsawMesh::EndType type, const JigsawMesh::EndJitter& jitter)
+{
+	EdgeSignature signature;
+	signature.mType = type;
+	signature.mOffset = 0;
+	signature.mScale = 0;
+	signature.mSkew = 0;
+
+	// Flat ends have no tab to deform.
+	if (type != JigsawMesh::eFLAT) {
+		signature.mOffset = Quantize(jitter.mOffset, SignatureStep);
+		signature.mScale = Quantize(jitter.mScale, SignatureStep);
+		signature.mSkew = Quantize(jitter.mSkew, SignatureStep);
+	}
+	return signature;
+}
+
+// Get the signature of a piece's left or top end, as the matching right or bottom end would produce it.
+JigsawSolver::EdgeSignature JigsawSolver::MakeComplementSignature(JigsawMesh::EndType type, const JigsawMesh::EndJitter& jitter)
+{
+	return MakeSignature(JigsawMesh::ComplementEndType(type), JigsawMesh::ComplementEndJitter(jitter));
+}
+
+// Get the bucket key for an edge signature.
+U64 JigsawSolver::MakeKey(const EdgeSignature& signature)
+{
+	U64 hash = Hash::FnvOffsetBasis;
+	hash = Hash::Combine(hash, static_cast<U32>(signature.mType));
+	hash = Hash::Combine(hash, static_cast<U32>(signature.mOffset));
+	hash = Hash::Combine(hash, static_cast<U32>(signature.mScale));
+	hash = Hash::Combine(hash, static_cast<U32>(signature.mSkew));
+	return hash;
+}
+
+// Check that a piece's flat ends match the board border at a grid position.
+bool JigsawSolver::IsBorderValid(U32 piece, U32 column, U32 row) const
+{
+	return (GetBorder((*mPieces)[piece].mPermutation) == GetBorder((row * mColumns) + column));
+}
+
+// Get the only unused piece whose left or top end matches a signature and fits a position.
+U32 JigsawSolver::FindUniqueCandidate(const Buckets& buckets, const EdgeSignature& signature, bool isLeft, U32 column, U32 row) const
+{
+	const Buckets::const_iterator found = buckets.find(MakeKey(signature));
+	if (found == buckets.end()) {
+		return NoPiece;
+	}
+
+	U32 result = NoPiece;
+	for (const U32 piece : found->second) {
+		const PieceSignature& candidate = mSignatures[piece];
+		const EdgeSignature& end = isLeft ? candidate.mLeft : candidate.mTop;
+		if ((end != signature) || mUsed[piece].load(std::memory_order_relaxed) || !IsBorderValid(piece, column, row)) {
+			continue;
+		}
+		if (result != NoPiece) {
+			return NoPiece;
+		}
+		result = piece;
+	}
+	return result;
+}
+
+// Place the first column, then grow every row to the right in parallel.
+bool JigsawSolver::SolveParallel()
+{
+	const U32 pieceCount = mColumns * mRows;
+	mPlacement.assign(pieceCount, NoPiece);
+	mUsed.reset(new std::atomic<bool>[pieceCount]);
+	for (U32 i = 0; i < pieceCount; ++i) {
+		mUsed[i].store(false, std::memory_order_relaxed);
+	}
+
+	// Walk down the left border from the top left corner.
+	if (mTopLeftPieces.size() != 1) {
+		return false;
+	}
+	U32 piece = mTopLeftPieces.front();
+	if (!IsBorderValid(piece, 0, 0)) {
+		return false;
+	}
+	mPlacement[0] = piece;
+	mUsed[piece].store(true, std::memory_order_relaxed);
+	for (U32 row = 1; row < mRows; ++row) {
+		const EdgeSignature& above = mSignatures[piece].mBottom;
+		piece = FindUniqueCandidate(mTopBuckets, above, false, 0, row);
+		if (piece == NoPiece) {
+			return false;
+		}
+		mPlacement[row * mColumns] = piece;
+		mUsed[piece].store(true, std::memory_order_relaxed);
+	}
+
+	// Each row is an independent front; workers take rows in turn.
+	std::atomic<U32> nextRow(0);
+	std::atomic<bool> failed(false);
+	auto worker = [&]() {
+		for (U32 row = nextRow.fetch_add(1); (row < mRows) && !failed.load(std::memory_order_relaxed); row = nextRow.fetch_add(1)) {
+			if (!SolveRow(row)) {
+				failed.store(true, std::memory_order_relaxed);
+			}
+		}
+	};
+	const U32 threadCount = std::min(mThreadCount, mRows);
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (U32 i = 1; i < threadCount; ++i) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	if (failed.load()) {
+		return false;
+	}
+
+	// Rows were grown without looking at each other, so check the edges between them.
+	for (U32 row = 1; row < mRows; ++row) {
+		for (U32 column = 0; column < mColumns; ++column) {
+			const U32 above = mPlacement[((row - 1) * mColumns) + column];
+			const U32 below = mPlacement[(row * mColumns) + column];
+			if (mSignatures[above].mBottom != mSignatures[below].mTop) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Grow a single row to the right from its first piece.
+bool JigsawSolver::SolveRow(U32 row)
+{
+	U32 piece = mPlacement[row * mColumns];
+	for (U32 column = 1; column < mColumns; ++column) {
+		const EdgeSignature& left = mSignatures[piece].mRight;
+		piece = FindUniqueCandidate(mLeftBuckets, left, true, column, row);
+		if (piece == NoPiece) {
+			return false;
+		}
+
+		// Another row claiming the same piece means the match wasn't really unique.
+		if (mUsed[piece].exchange(true)) {
+			return false;
+		}
+		mPlacement[(row * mColumns) + column] = piece;
+	}
+	return true;
+}
+
+// Group pieces with identical signatures into interchangeable classes.
+void JigsawSolver::BuildClasses()
+{
+	mClassPieces.clear();
+	for (Indices& classes : mBorderClasses) {
+		classes.clear();
+	}
+	mClassTopBuckets.clear();
+	mClassRightBuckets.clear();
+	mClassBottomBuckets.clear();
+	mClassLeftBuckets.clear();
+
+	Buckets classLookup;
+	const U32 pieceCount = static_cast<U32>(mSignatures.size());
+	for (U32 i = 0; i < pieceCount; ++i) {
+		const PieceSignature& signature = mSignatures[i];
+		const U64 key = MakeKey(signature.mTop) ^ (MakeKey(signature.mRight) * 3U) ^
+			(MakeKey(signature.mBottom) * 5U) ^ (MakeKey(signature.mLeft) * 7U);
+
+		// Find an existing class with the same signature, or start a new one.
+		Indices& classes = classLookup[key];
+		U32 found = NoPiece;
+		for (const U32 pieceClass : classes) {
+			if (mSignatures[mClassPieces[pieceClass].front()] == signature) {
+				found = pieceClass;
+				break;
+			}
+		}
+		if (found == NoPiece) {
+			found = static_cast<U32>(mClassPieces.size());
+			mClassPieces.emplace_back();
+			classes.push_back(found);
+			mClassTopBuckets[MakeKey(signature.mTop)].push_back(found);
+			mClassRightBuckets[MakeKey(signature.mRight)].push_back(found);
+			mClassBottomBuckets[MakeKey(signature.mBottom)].push_back(found);
+			mClassLeftBuckets[MakeKey(signature.mLeft)].push_back(found);
+			mBorderClasses[GetBorder(mPieces->at(i).mPermutation)].push_back(found);
+		}
+		mClassPieces[found].push_back(i);
+	}
+}
+
+// Get which ends of a permutation are flat, as a bit mask.
+U32 JigsawSolver::GetBorder(const JigsawMesh::Permutation& permutation)
+{
+	return ((permutation.mTop == JigsawMesh::eFLAT) ? TopBorder : 0U) |
+		((permutation.mRight == JigsawMesh::eFLAT) ? RightBorder : 0U) |
+		((permutation.mBottom == JigsawMesh::eFLAT) ? BottomBorder : 0U) |
+		((permutation.mLeft == JigsawMesh::eFLAT) ? LeftBorder : 0U);
+}
+
+// Get which ends must be flat at a grid position, as a bit mask.
+U32 JigsawSolver::GetBorder(U32 position) const
+{
+	const U32 column = position % mColumns;
+	const U32 row = position / mColumns;
+	return ((row == 0) ? TopBorder : 0U) |
+		(((column + 1) == mColumns) ? RightBorder : 0U) |
+		(((row + 1) == mRows) ? BottomBorder : 0U) |
+		((column == 0) ? LeftBorder : 0U);
+}
+
+// Collect the ends required by a position's placed neighbours.
+// Border ends aren't included; they're checked with the border mask.
+U32 JigsawSolver::GatherRequirements(U32 position, Requirement* requirements) const
+{
+	const U32 column = position % mColumns;
+	const U32 row = position / mColumns;
+	U32 requirementCount = 0;
+	if ((row != 0) && (mPlacement[position - mColumns] != NoPiece)) {
+		requirements[requirementCount++] = { &mClassTopBuckets, &PieceSignature::mTop, mSignatures[mPlacement[position - mColumns]].mBottom };
+	}
+	if (((column + 1) < mColumns) && (mPlacement[position + 1] != NoPiece)) {
+		requirements[requirementCount++] = { &mClassRightBuckets, &PieceSignature::mRight, mSignatures[mPlacement[position + 1]].mLeft };
+	}
+	if (((row + 1) < mRows) && (mPlacement[position + mColumns] != NoPiece)) {
+		requirements[requirementCount++] = { &mClassBottomBuckets, &PieceSignature::mBottom, mSignatures[mPlacement[position + mColumns]].mTop };
+	}
+	if ((column != 0) && (mPlacement[position - 1] != NoPiece)) {
+		requirements[requirementCount++] = { &mClassLeftBuckets, &PieceSignature::mLeft, mSignatures[mPlacement[position - 1]].mRight };
+	}
+	return requirementCount;
+}
+
+// Get the classes with pieces left that fit all placed neighbours of a position.
+U32 JigsawSolver::FindFittingClasses(U32 position, Indices& classes) const
+{
+	classes.clear();
+	Requirement requirements[RequirementCount];
+	const U32 requirementCount = GatherRequirements(position, requirements);
+	if (requirementCount == 0) {
+		return 0;
+	}
+
+	// Search the smallest bucket and check the other ends against each class.
+	const Indices* smallest = nullptr;
+	for (U32 i = 0; i < requirementCount; ++i) {
+		const Requirement& requirement = requirements[i];
+		const Buckets::const_iterator found = requirement.mBuckets->find(MakeKey(requirement.mSignature));
+		if (found == requirement.mBuckets->end()) {
+			return 0;
+		}
+		if ((smallest == nullptr) || (found->second.size() < smallest->size())) {
+			smallest = &found->second;
+		}
+	}
+
+	const U32 border = GetBorder(position);
+	for (const U32 pieceClass : *smallest) {
+		const U32 piece = mClassPieces[pieceClass].front();
+		if ((mClassRemaining[pieceClass] == 0) || (GetBorder((*mPieces)[piece].mPermutation) != border)) {
+			continue;
+		}
+
+		const PieceSignature& signature = mSignatures[piece];
+		bool isFitting = true;
+		for (U32 i = 0; (i < requirementCount) && isFitting; ++i) {
+			isFitting = ((signature.*requirements[i].mEnd) == requirements[i].mSignature);
+		}
+		if (isFitting) {
+			classes.push_back(pieceClass);
+		}
+	}
+	return static_cast<U32>(smallest->size());
+}
+
+// Get the classes that fit the most placed neighbours of a position, ignoring the piece in it.
+U32 JigsawSolver::FindBestClasses(U32 position, Indices& classes) const
+{
+	classes.clear();
+	Requirement requirements[RequirementCount];
+	const U32 requirementCount = GatherRequirements(position, requirements);
+	const U32 border = GetBorder(position);
+
+	// Every class that fits at least one neighbour is in one of the neighbours' buckets.
+	// Look through the smallest buckets first, and skip large ones once there are candidates.
+	const Indices* buckets[RequirementCount];
+	for (U32 i = 0; i < requirementCount; ++i) {
+		const Requirement& requirement = requirements[i];
+		const Buckets::const_iterator found = requirement.mBuckets->find(MakeKey(requirement.mSignature));
+		buckets[i] = (found != requirement.mBuckets->end()) ? &found->second : nullptr;
+	}
+	U32 order[RequirementCount] = { 0U, 1U, 2U, 3U };
+	std::sort(order, order + requirementCount, [&buckets](U32 a, U32 b) {
+		const size_t aSize = (buckets[a] != nullptr) ? buckets[a]->size() : 0;
+		const size_t bSize = (buckets[b] != nullptr) ? buckets[b]->size() : 0;
+		return (aSize < bSize);
+	});
+
+	U32 bestScore = 0;
+	size_t scanned = 0;
+	for (U32 i = 0; i < requirementCount; ++i) {
+		const Indices* bucket = buckets[order[i]];
+		if (bucket == nullptr) {
+			continue;
+		}
+		if (!classes.empty() && ((scanned + bucket->size()) > MaximumScannedClasses)) {
+			break;
+		}
+		scanned += bucket->size();
+
+		for (const U32 pieceClass : *bucket) {
+			const U32 piece = mClassPieces[pieceClass].front();
+			if (GetBorder((*mPieces)[piece].mPermutation) != border) {
+				continue;
+			}
+
+			// Count matches once, from the first bucket the class is in.
+			const PieceSignature& signature = mSignatures[piece];
+			U32 score = 0;
+			bool isFirst = true;
+			for (U32 j = 0; j < requirementCount; ++j) {
+				const Requirement& requirement = requirements[order[j]];
+				if ((signature.*requirement.mEnd) == requirement.mSignature) {
+					isFirst = isFirst && (j >= i);
+					++score;
+				}
+			}
+			if (!isFirst || (score < bestScore)) {
+				continue;
+			}
+			if (score > bestScore) {
+				bestScore = score;
+				classes.clear();
+			}
+			classes.push_back(pieceClass);
+		}
+	}
+	return bestScore;
+}
+
+// Count the ends of a position that don't match their placed neighbours.
+U32 JigsawSolver::CountConflicts(U32 position) const
+{
+	const U32 column = position % mColumns;
+	const U32 row = position / mColumns;
+	const PieceSignature& signature = mSignatures[mPlacement[position]];
+	U32 conflicts = 0;
+	if ((row != 0) && (mSignatures[mPlacement[position - mColumns]].mBottom != signature.mTop)) {
+		++conflicts;
+	}
+	if (((column + 1) < mColumns) && (mSignatures[mPlacement[position + 1]].mLeft != signature.mRight)) {
+		++conflicts;
+	}
+	if (((row + 1) < mRows) && (mSignatures[mPlacement[position + mColumns]].mTop != signature.mBottom)) {
+		++conflicts;
+	}
+	if ((column != 0) && (mSignatures[mPlacement[position - 1]].mRight != signature.mLeft)) {
+		++conflicts;
+	}
+	return conflicts;
+}
+
+// Count the mismatched edges touching either of two positions.
+U32 JigsawSolver::CountConflicts(U32 first, U32 second) const
+{
+	U32 conflicts = CountConflicts(first) + CountConflicts(second);
+
+	// An edge shared by both positions was counted twice.
+	const U32 low = std::min(first, second);
+	const U32 high = std::max(first, second);
+	if (((high == (low + 1)) && ((high % mColumns) != 0) && (mSignatures[mPlacement[low]].mRight != mSignatures[mPlacement[high]].mLeft)) ||
+		((high == (low + mColumns)) && (mSignatures[mPlacement[low]].mBottom != mSignatures[mPlacement[high]].mTop)))
+	{
+		--conflicts;
+	}
+	return conflicts;
+}
+
+// Place a piece of a class in an empty position and queue its empty neighbours.
+void JigsawSolver::PlaceClass(U32 position, U32 pieceClass, Indices& pending)
+{
+	assert(mClassRemaining[pieceClass] != 0);
+	const U32 remaining = --mClassRemaining[pieceClass];
+	mPlacement[position] = mClassPieces[pieceClass][remaining];
+	mPlacedClasses[position] = pieceClass;
+	mClassSlots[position] = static_cast<U32>(mClassPositions[pieceClass].size());
+	mClassPositions[pieceClass].push_back(position);
+
+	const U32 column = position % mColumns;
+	const U32 row = position / mColumns;
+	if ((row != 0) && (mPlacement[position - mColumns] == NoPiece)) {
+		pending.push_back(position - mColumns);
+	}
+	if (((column + 1) < mColumns) && (mPlacement[position + 1] == NoPiece)) {
+		pending.push_back(position + 1);
+	}
+	if (((row + 1) < mRows) && (mPlacement[position + mColumns] == NoPiece)) {
+		pending.push_back(position + mColumns);
+	}
+	if ((column != 0) && (mPlacement[position - 1] == NoPiece)) {
+		pending.push_back(position - 1);
+	}
+}
+
+// Return the piece in a position to its class.
+void JigsawSolver::RemoveClass(U32 position)
+{
+	const U32 pieceClass = mPlacedClasses[position];
+	assert(mClassPositions[pieceClass].back() == position);
+	mClassPositions[pieceClass].pop_back();
+	++mClassRemaining[pieceClass];
+	mPlacement[position] = NoPiece;
+	mPlacedClasses[position] = NoPiece;
+}
+
+// Empty the grid and return every piece to its class.
+void JigsawSolver::ClearClasses()
+{
+	const U32 pieceCount = mColumns * mRows;
+	mPlacement.assign(pieceCount, NoPiece);
+	mPlacedClasses.assign(pieceCount, NoPiece);
+	mClassSlots.assign(pieceCount, 0);
+	mClassPositions.assign(mClassPieces.size(), Indices());
+	mClassRemaining.clear();
+	for (const Indices& pieces : mClassPieces) {
+		mClassRemaining.push_back(static_cast<U32>(pieces.size()));
+	}
+}
+
+// Swap the pieces in two positions.
+void JigsawSolver::SwapPositions(U32 first, U32 second)
+{
+	const U32 firstClass = mPlacedClasses[first];
+	const U32 secondClass = mPlacedClasses[second];
+	mClassPositions[firstClass][mClassSlots[first]] = second;
+	mClassPositions[secondClass][mClassSlots[second]] = first;
+	std::swap(mClassSlots[first], mClassSlots[second]);
+	std::swap(mPlacedClasses[first], mPlacedClasses[second]);
+	std::swap(mPlacement[first], mPlacement[second]);
+}
+
+// Queue a position for repair if it has conflicts and isn't queued yet.
+void JigsawSolver::QueueConflicts(U32 position, Indices& conflicted, std::vector<bool>& isQueued) const
+{
+	if (!isQueued[position] && (CountConflicts(position) != 0)) {
+		isQueued[position] = true;
+		conflicted.push_back(position);
+	}
+}
+
+// Queue a position and its neighbours for repair.
+void JigsawSolver::QueueNeighbourConflicts(U32 position, Indices& conflicted, std::vector<bool>& isQueued) const
+{
+	const U32 column = position % mColumns;
+	const U32 row = position / mColumns;
+	QueueConflicts(position, conflicted, isQueued);
+	if (row != 0) {
+		QueueConflicts(position - mColumns, conflicted, isQueued);
+	}
+	if ((column + 1) < mColumns) {
+		QueueConflicts(position + 1, conflicted, isQueued);
+	}
+	if ((row + 1) < mRows) {
+		QueueConflicts(position + mColumns, conflicted, isQueued);
+	}
+	if (column != 0) {
+		QueueConflicts(position - 1, conflicted, isQueued);
+	}
+}
+
+// Place pieces that are the only fit for their placed neighbours until none are left.
+bool JigsawSolver::PlaceForcedClasses(Indices& pending, Indices& placed, U64& steps, U64 maximumSteps)
+{
+	Indices classes;
+	while (!pending.empty()) {
+		const U32 next = pending.back();
+		pending.pop_back();
+		if (mPlacement[next] != NoPiece) {
+			continue;
+		}
+
+		steps += FindFittingClasses(next, classes) + 1;
+		if (classes.empty() || (steps >= maximumSteps)) {
+			pending.clear();
+			return false;
+		}
+		if (classes.size() == 1) {
+			PlaceClass(next, classes.front(), pending);
+			placed.push_back(next);
+		}
+	}
+	return true;
+}
+
+// Get the grid position at an index of the search order.
+U32 JigsawSolver::GetScanPosition(U32 scanIndex) const
+{
+	if (mColumns <= mRows) {
+		return scanIndex;
+	}
+	return ((scanIndex % mRows) * mColumns) + (scanIndex / mRows);
+}
+
+// Find an assembly by backtracking over the positions where more than one class fits.
+// Positions are chosen in scan order, so each has its top or left neighbour placed. Forced pieces are placed
+// after every choice, which both skips positions with a single fit and finds contradictions early. Pieces with the
+// same signature are interchangeable, so classes are tried instead of pieces.
+bool JigsawSolver::SolveSearch(bool& isExhausted)
+{
+	isExhausted = false;
+	ClearClasses();
+
+	const U32 pieceCount = mColumns * mRows;
+	const U64 maximumSteps = std::max(static_cast<U64>(pieceCount) * SearchStepsPerPiece, MinimumSearchSteps);
+	U64 steps = 0;
+	std::vector<SearchFrame> frames;
+	Indices placed;
+	Indices pending;
+	U32 scanIndex = 0;
+	for (;;) {
+		while ((scanIndex < pieceCount) && (mPlacement[GetScanPosition(scanIndex)] != NoPiece)) {
+			++scanIndex;
+		}
+		if (scanIndex == pieceCount) {
+			return true;
+		}
+
+		// The top left corner has no neighbours yet, so any class for its border fits.
+		const U32 position = GetScanPosition(scanIndex);
+		frames.emplace_back();
+		SearchFrame& frame = frames.back();
+		frame.mScanIndex = scanIndex;
+		frame.mNextClass = 0;
+		frame.mPlacedCount = placed.size();
+		steps += FindFittingClasses(position, frame.mClasses) + 1;
+		if (position == 0) {
+			for (const U32 pieceClass : mBorderClasses[GetBorder(position)]) {
+				frame.mClasses.push_back(pieceClass);
+			}
+		}
+
+		// Try the next class at the newest position, going back to earlier positions once one has none left.
+		for (;;) {
+			SearchFrame& current = frames.back();
+			while (placed.size() > current.mPlacedCount) {
+				RemoveClass(placed.back());
+				placed.pop_back();
+			}
+			if (current.mNextClass == current.mClasses.size()) {
+				frames.pop_back();
+				if (frames.empty()) {
+					isExhausted = true;
+					return false;
+				}
+				continue;
+			}
+			if (steps >= maximumSteps) {
+				ClearClasses();
+				return false;
+			}
+
+			scanIndex = current.mScanIndex;
+			const U32 next = GetScanPosition(scanIndex);
+			PlaceClass(next, current.mClasses[current.mNextClass++], pending);
+			placed.push_back(next);
+			if (PlaceForcedClasses(pending, placed, steps, maximumSteps)) {
+				break;
+			}
+		}
+	}
+}
+
+// Find an assembly when some edges match more than one piece.
+bool JigsawSolver::SolveRepair(U32 seed)
+{
+	const U32 pieceCount = mColumns * mRows;
+	ClearClasses();
+
+	// Place pieces that are the only fit for their neighbours first, starting from the top left.
+	// Where that stops, guess the most common fitting class at the first empty position in row-major order,
+	// or any class that fits the border once none fit.
+	Indices classes;
+	Indices pending;
+	U32 borderCursors[BorderCount] = {};
+	U32 position = 0;
+	for (;;) {
+		while (!pending.empty()) {
+			const U32 next = pending.back();
+			pending.pop_back();
+			if (mPlacement[next] == NoPiece) {
+				FindFittingClasses(next, classes);
+				if (classes.size() == 1) {
+					PlaceClass(next, classes.front(), pending);
+				}
+			}
+		}
+
+		while ((position < pieceCount) && (mPlacement[position] != NoPiece)) {
+			++position;
+		}
+		if (position == pieceCount) {
+			break;
+		}
+
+		FindFittingClasses(position, classes);
+		U32 best = NoPiece;
+		for (const U32 pieceClass : classes) {
+			if ((best == NoPiece) || (mClassRemaining[pieceClass] > mClassRemaining[best])) {
+				best = pieceClass;
+			}
+		}
+		if (best == NoPiece) {
+			const U32 border = GetBorder(position);
+			const Indices& borderClasses = mBorderClasses[border];
+			U32& cursor = borderCursors[border];
+			while ((cursor < borderClasses.size()) && (mClassRemaining[borderClasses[cursor]] == 0)) {
+				++cursor;
+			}
+			if (cursor == borderClasses.size()) {
+				mPlacement.assign(pieceCount, NoPiece);
+				return false;
+			}
+			best = borderClasses[cursor];
+		}
+		PlaceClass(position, best, pending);
+	}
+
+	// Repair conflicts by swapping in pieces that fit better, accepting the odd worse swap to get out of local minima.
+	std::mt19937 random(seed);
+	std::vector<bool> isQueued(pieceCount, false);
+	Indices conflicted;
+	for (position = 0; position < pieceCount; ++position) {
+		QueueConflicts(position, conflicted, isQueued);
+	}
+	const U64 maximumSteps = std::max(static_cast<U64>(pieceCount) * RepairStepsPerPiece, MinimumRepairSteps);
+	for (U64 step = 0; !conflicted.empty(); ++step) {
+		if (step == maximumSteps) {
+			mPlacement.assign(pieceCount, NoPiece);
+			return false;
+		}
+
+		// Drop positions that were fixed by earlier swaps.
+		const U32 index = static_cast<U32>(random() % conflicted.size());
+		position = conflicted[index];
+		if (CountConflicts(position) == 0) {
+			isQueued[position] = false;
+			conflicted[index] = conflicted.back();
+			conflicted.pop_back();
+			continue;
+		}
+
+		// Swap with a random position holding a class that fits this one's neighbours best.
+		// When that's the class already here, swap with any position on the same border instead to get out of local minima.
+		U32 other = position;
+		FindBestClasses(position, classes);
+		if (!classes.empty()) {
+			const Indices& positions = mClassPositions[classes[random() % classes.size()]];
+			other = positions[random() % positions.size()];
+		}
+		if (mPlacedClasses[other] == mPlacedClasses[position]) {
+			const U32 border = GetBorder(position);
+			for (U32 attempt = 0; (attempt < RandomSwapAttempts) && (mPlacedClasses[other] == mPlacedClasses[position]); ++attempt) {
+				const U32 sample = static_cast<U32>(random() % pieceCount);
+				other = (GetBorder(sample) == border) ? sample : position;
+			}
+			if (mPlacedClasses[other] == mPlacedClasses[position]) {
+				continue;
+			}
+		}
+
+		const U32 before = CountConflicts(position, other);
+		SwapPositions(position, other);
+		const U32 after = CountConflicts(position, other);
+		if ((after > before) && ((random() % WorseSwapOdds) != 0)) {
+			SwapPositions(position, other);
+			continue;
+		}
+		QueueNeighbourConflicts(position, conflicted, isQueued);
+		QueueNeighbourConflicts(other, conflicted, isQueued);
+	}
+	return true;
+}
+
+bool JigsawSolver::EdgeSignature::operator==(const EdgeSignature& other) const
+{
+	return (mType == other.mType) &&
+		(mOffset == other.mOffset) &&
+		(mScale == other.mScale) &&
+		(mSkew == other.mSkew);
+}
+
+bool JigsawSolver::EdgeSignature::operator!=(const EdgeSignature& other) const
+{
+	return !(*this == other);
+}
+
+bool JigsawSolver::PieceSignature::operator==(const PieceSignature& other) const
+{
+	return (mTop == other.mTop) &&
+		(mRight == other.mRight) &&
+		(mBottom == other.mBottom) &&
+		(mLeft == other.mLeft);
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "Common.h"
+#include "JigsawBoard.h"
+#include "JigsawMesh.h"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+// Solver that assembles a board from a shuffled set of its pieces.
+// Pieces keep their orientation; each interior edge is matched by its end type complement and quantized tab jitter.
+class JigsawSolver
+{
+public:
+	// Create a solver that uses up to the given number of threads, or one per hardware thread if zero.
+	explicit JigsawSolver(U32 threadCount = 0);
+	~JigsawSolver() = default;
+
+	// Find the board dimensions and the grid position of every piece.
+	// Returns false if the pieces don't form a complete board. When many edges match several pieces, the search can
+	// run out of steps before trying every choice; a heuristic repair takes over then and may miss a board that exists.
+	bool Solve(const JigsawBoard::Pieces& pieces);
+
+	// Get number of columns of the solved board.
+	inline U32 GetColumns() const
+	{
+		return mColumns;
+	}
+
+	// Get number of rows of the solved board.
+	inline U32 GetRows() const
+	{
+		return mRows;
+	}
+
+	// Get the index of the input piece placed at a grid position.
+	inline U32 GetPieceIndex(U32 column, U32 row) const
+	{
+		return mPlacement[(row * mColumns) + column];
+	}
+
+	// Get the input piece index for every grid position in row-major order.
+	inline const Indices& GetPlacement() const
+	{
+		return mPlacement;
+	}
+
+private:
+	// Jitter quantization step; complementary ends quantize to exactly opposite values.
+	static constexpr F32 SignatureStep = 1.f / 65536.f;
+
+	// Marks an empty grid position.
+	static constexpr U32 NoPiece = ~0U;
+
+	// Maximum number of positions and classes the backtracking search looks at, per piece.
+	static constexpr U32 SearchStepsPerPiece = 4096U;
+
+	// Small boards get a fixed number of search steps instead.
+	static constexpr U64 MinimumSearchSteps = 1U << 22;
+
+	// Maximum number of repair swaps tried, per piece.
+	static constexpr U32 RepairStepsPerPiece = 32U;
+
+	// Small boards get a fixed number of repair swaps instead.
+	static constexpr U64 MinimumRepairSteps = 65536U;
+
+	// Number of times the repair is restarted with a different random sequence.
+	static constexpr U32 RepairAttempts = 4U;
+
+	// Number of classes looked through for a swap before settling for the candidates found so far.
+	static constexpr size_t MaximumScannedClasses = 256;
+
+	// One in this many swaps that add conflicts is kept anyway.
+	static constexpr U32 WorseSwapOdds = 16U;
+
+	// Number of random positions tried when looking for any swap on the same border.
+	static constexpr U32 RandomSwapAttempts = 16U;
+
+	// Bits for which ends of a piece or position are on the board border.
+	static constexpr U32 TopBorder = 1U;
+	static constexpr U32 RightBorder = 2U;
+	static constexpr U32 BottomBorder = 4U;
+	static constexpr U32 LeftBorder = 8U;
+	static constexpr U32 BorderCount = 16U;
+
+	// Maximum number of neighbours of a position.
+	static constexpr U32 RequirementCount = 4U;
+
+	// Shape of one edge as seen from the piece to its left or above.
+	// The piece on the other side of the edge must produce an equal signature.
+	struct EdgeSignature
+	{
+		JigsawMesh::EndType mType;
+		I32 mOffset;
+		I32 mScale;
+		I32 mSkew;
+
+		bool operator==(const EdgeSignature& other) const;
+		bool operator!=(const EdgeSignature& other) const;
+	};
+
+	// Edge signatures for all four ends of a piece.
+	struct PieceSignature
+	{
+		EdgeSignature mTop;
+		EdgeSignature mRight;
+		EdgeSignature mBottom;
+		EdgeSignature mLeft;
+
+		bool operator==(const PieceSignature& other) const;
+	};
+
+	// Pieces or classes indexed by the hash of an edge signature.
+	using Buckets = std::unordered_map<U64, Indices>;
+
+	// Position the backtracking search chose between classes at, and the classes left to try there.
+	struct SearchFrame
+	{
+		U32 mScanIndex; // Index of the position in the search order.
+		Indices mClasses;
+		U32 mNextClass;
+		size_t mPlacedCount; // Number of placements made before this position's.
+	};
+
+	// End a neighbour requires of a position, and the classes that have it.
+	struct Requirement
+	{
+		const Buckets* mBuckets;
+		EdgeSignature PieceSignature::* mEnd;
+		EdgeSignature mSignature;
+	};
+
+private:
+	// Get the signature of a piece's right or bottom end.
+	static EdgeSignature MakeSignature(JigsawMesh::EndType type, const JigsawMesh::EndJitter& jitter);
+
+	// Get the signature of a piece's left or top end, as the matching right or bottom end would produce it.
+	static EdgeSignature MakeComplementSignature(JigsawMesh::EndType type, const JigsawMesh::EndJitter& jitter);
+
+	// Check that a piece's flat ends match the board border at a grid position.
+	bool IsBorderValid(U32 piece, U32 column, U32 row) const;
+
+	// Get the bucket key for an edge signature.
+	static U64 MakeKey(const EdgeSignature& signature);
+
+	// Get the only unused piece whose left or top end matches a signature and fits a position.
+	// Returns no piece if there isn't exactly one.
+	U32 FindUniqueCandidate(const Buckets& buckets, const EdgeSignature& signature, bool isLeft, U32 column, U32 row) const;
+
+	// Place the first column, then grow every row to the right in parallel.
+	// Returns false if any position is ambiguous.
+	bool SolveParallel();
+
+	// Grow a single row to the right from its first piece.
+	bool SolveRow(U32 row);
+
+	// Group pieces with identical signatures into interchangeable classes.
+	void BuildClasses();
+
+	// Get which ends of a permutation are flat, as a bit mask.
+	static U32 GetBorder(const JigsawMesh::Permutation& permutation);
+
+	// Get which ends must be flat at a grid position, as a bit mask.
+	U32 GetBorder(U32 position) const;
+
+	// Collect the ends required by a position's placed neighbours.
+	U32 GatherRequirements(U32 position, Requirement* requirements) const;
+
+	// Get the classes with pieces left that fit all placed neighbours of a position.
+	// Returns the number of classes looked at.
+	U32 FindFittingClasses(U32 position, Indices& classes) const;
+
+	// Get the classes that fit the most placed neighbours of a position, ignoring the piece in it.
+	// Returns the number of neighbours they fit.
+	U32 FindBestClasses(U32 position, Indices& classes) const;
+
+	// Count the ends of a position that don't match their neighbours.
+	U32 CountConflicts(U32 position) const;
+
+	// Count the mismatched edges touching either of two positions.
+	U32 CountConflicts(U32 first, U32 second) const;
+
+	// Place a piece of a class in an empty position and queue its empty neighbours.
+	void PlaceClass(U32 position, U32 pieceClass, Indices& pending);
+
+	// Return the piece in a position to its class.
+	// Positions must be emptied in the reverse order they were placed in.
+	void RemoveClass(U32 position);
+
+	// Empty the grid and return every piece to its class.
+	void ClearClasses();
+
+	// Swap the pieces in two positions.
+	void SwapPositions(U32 first, U32 second);
+
+	// Queue a position for repair if it has conflicts and isn't queued yet.
+	void QueueConflicts(U32 position, Indices& conflicted, std::vector<bool>& isQueued) const;
+
+	// Queue a position and its neighbours for repair.
+	void QueueNeighbourConflicts(U32 position, Indices& conflicted, std::vector<bool>& isQueued) const;
+
+	// Place pieces that are the only fit for their placed neighbours until none are left.
+	// Returns false if a queued position has no fitting piece left or the search runs out of steps.
+	bool PlaceForcedClasses(Indices& pending, Indices& placed, U64& steps, U64 maximumSteps);
+
+	// Get the grid position at an index of the search order.
+	// The order runs along the shorter side of the board first, so a wrong choice meets its placed neighbours sooner.
+	U32 GetScanPosition(U32 scanIndex) const;
+
+	// Find an assembly by backtracking over the positions where more than one class fits.
+	// Returns false if there's no assembly or the search ran out of steps; only the former sets exhausted.
+	bool SolveSearch(bool& isExhausted);
+
+	// Find an assembly when some edges match more than one piece.
+	// Pieces that are the only fit are placed first and the rest greedily, then pieces are swapped until every edge matches.
+	// Swaps are picked with a random sequence from the given seed.
+	bool SolveRepair(U32 seed);
+
+private:
+	U32 mThreadCount;
+
+	// Input pieces and their signatures.
+	const JigsawBoard::Pieces* mPieces;
+	std::vector<PieceSignature> mSignatures;
+
+	// Pieces by left end and by top end.
+	Buckets mLeftBuckets;
+	Buckets mTopBuckets;
+
+	// Pieces with both the top and left end flat.
+	Indices mTopLeftPieces;
+
+	// Solved board.
+	U32 mColumns;
+	U32 mRows;
+	Indices mPlacement;
+	std::unique_ptr<std::atomic<bool>[]> mUsed;
+
+	// Pieces of each class and the number of them not placed yet.
+	std::vector<Indices> mClassPieces;
+	Indices mClassRemaining;
+
+	// Class placed in each position, positions holding each class, and each position's entry in that list.
+	Indices mPlacedClasses;
+	std::vector<Indices> mClassPositions;
+	Indices mClassSlots;
+
+	// Classes by the border they fit.
+	Indices mBorderClasses[BorderCount];
+
+	// Classes by each of their ends.
+	Buckets mClassTopBuckets;
+	Buckets mClassRightBuckets;
+	Buckets mClassBottomBuckets;
+	Buckets mClassLeftBuckets;
+};
@@ -1,4 +1,5 @@
 #include "Common.h"
+#include "JigsawGenerator.h"
 #include "JigsawMesh.h"
 #include "JigsawPiece.h"
 #include <cassert>
@@ -9,17 +10,18 @@ int main(int argc, char* argv[])
 	Unused(argc, argv);
 
     // Generate end vertices.
-	JigsawMesh::BuildEndVertices();
+	const JigsawGenerator generator;
 
 	// Generate all permutations.
-	JigsawPiece::GeneratePermutations();
+	JigsawMesh::MeshMap permutationMeshes;
+	JigsawPiece::GeneratePermutations(generator, permutationMeshes);
 
 	// Build the mesh.
 	JigsawMesh piece;
 	const JigsawMesh::Permutation permutation = {
 		JigsawMesh::eOUTWARD, JigsawMesh::eOUTWARD, JigsawMesh::eINWARD, JigsawMesh::eINWARD
 	};
-	piece.Generate(permutation);
+	piece.Generate(generator, permutation);
     system("pause");
     return 0;
 }
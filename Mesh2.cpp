@@ -1,19 +1,26 @@
 #include "Common.h"
 #include "Mesh2.h"
+#include "Predicates2.h"
 #include <cassert>
+#include <limits>
 #include <tuple>
 
+namespace
+{
+	// Marks a polygon vertex that isn't in the reflex set.
+	static constexpr U32 NoReflexSlot = ~0U;
+}
+
 Mesh2::Mesh2(Polygon2& polygon)
 {
 	mPolygon = std::move(polygon);
 }
 
 // Check if a point is to the left or right of a segment.
+// Uses the exact orientation so near-collinear vertices are classified consistently.
 bool Mesh2::IsVertexLeft(const Vector2& start, const Vector2& end, const Vector2& point)
 {
-	const float determinantX = (end.x - start.x) * (point.y - start.y);
-	const float determinantY = (end.y - start.y) * (point.x - start.x);
-	return (determinantX > determinantY);
+	return (Predicates2::Orient(start, end, point) > 0);
 }
 
 // Return whether a point at a given index is a reflex.
@@ -26,45 +33,122 @@ bool Mesh2::IsVertexReflex(const Polygon2& polygon, const TriangulateNode& node)
     return IsVertexLeft(previous, current, next);
 }
 
-// Return whether one point is contained in a triangle centered at another non-reflex point.
-bool Mesh2::IsVertexInEar(const Polygon2& polygon, const TriangulateNode& earNode, const Vector2& vertex)
+// Gather the reflex vertices of the whole polygon into coordinate arrays.
+void Mesh2::GatherReflexVertices(const Polygon2& polygon, const TriangulateNode* head, U32 count, ReflexVertices& reflex)
 {
-	const Vertices2& vertices = polygon.GetVertices();
-    const Vector2& previous = vertices[earNode.mIndex];
-    const Vector2& center = vertices[earNode.mPrevious->mIndex];
-    const Vector2& next = vertices[earNode.mNext->mIndex];
-    const bool leftAB = IsVertexLeft(previous, center, vertex);
-    const bool leftBC = IsVertexLeft(center, next, vertex);
-    const bool leftCA = IsVertexLeft(next, previous, vertex);
-    return (leftAB == leftBC) && (leftBC == leftCA);
+	reflex.mX.clear();
+	reflex.mY.clear();
+	reflex.mIndices.clear();
+	reflex.mSlots.assign(polygon.GetVertices().size(), NoReflexSlot);
+	for (std::vector<I32>& orientations : reflex.mOrientations) {
+		orientations.clear();
+	}
+
+	const TriangulateNode* node = head;
+	for (U32 c = count; c != 0; --c, node = node->mNext) {
+		if (IsVertexReflex(polygon, *node)) {
+			AddReflexVertex(polygon, *node, reflex);
+		}
+	}
+}
+
+// Check if a node is in the reflex set.
+bool Mesh2::IsInReflexSet(const ReflexVertices& reflex, const TriangulateNode& node)
+{
+	return (reflex.mSlots[node.mIndex] != NoReflexSlot);
+}
+
+// Append a node's vertex to the reflex arrays.
+void Mesh2::AddReflexVertex(const Polygon2& polygon, const TriangulateNode& node, ReflexVertices& reflex)
+{
+	assert(!IsInReflexSet(reflex, node));
+	const Vector2& vertex = polygon.GetVertices()[node.mIndex];
+	reflex.mSlots[node.mIndex] = static_cast<U32>(reflex.mIndices.size());
+	reflex.mX.push_back(vertex.x);
+	reflex.mY.push_back(vertex.y);
+	reflex.mIndices.push_back(node.mIndex);
+	for (std::vector<I32>& orientations : reflex.mOrientations) {
+		orientations.push_back(0);
+	}
+}
+
+// Remove a node's vertex by moving the last reflex vertex into its slot.
+void Mesh2::RemoveReflexVertex(const TriangulateNode& node, ReflexVertices& reflex)
+{
+	const U32 slot = reflex.mSlots[node.mIndex];
+	if (slot == NoReflexSlot) {
+		return;
+	}
+
+	const U32 last = static_cast<U32>(reflex.mIndices.size()) - 1;
+	const U32 lastIndex = reflex.mIndices[last];
+	reflex.mX[slot] = reflex.mX[last];
+	reflex.mY[slot] = reflex.mY[last];
+	reflex.mIndices[slot] = lastIndex;
+	reflex.mSlots[lastIndex] = slot;
+	reflex.mSlots[node.mIndex] = NoReflexSlot;
+	reflex.mX.pop_back();
+	reflex.mY.pop_back();
+	reflex.mIndices.pop_back();
+	for (std::vector<I32>& orientations : reflex.mOrientations) {
+		orientations.pop_back();
+	}
+}
+
+// Add or remove a node's vertex from the reflex set after its neighbours changed.
+// Clipping only ever makes simple polygons more convex, but self-touching outlines may turn a vertex reflex.
+void Mesh2::UpdateReflexVertex(const Polygon2& polygon, const TriangulateNode& node, ReflexVertices& reflex)
+{
+	const bool isReflex = IsVertexReflex(polygon, node);
+	if (isReflex != IsInReflexSet(reflex, node)) {
+		if (isReflex) {
+			AddReflexVertex(polygon, node, reflex);
+		}
+		else {
+			RemoveReflexVertex(node, reflex);
+		}
+	}
 }
 
 // Check if an ear centered at the given node can be removed.
-bool Mesh2::CanRemoveEar(const Polygon2& polygon, const TriangulateNode& node)
+bool Mesh2::CanRemoveEar(const Polygon2& polygon, const TriangulateNode& node, ReflexVertices& reflex)
 {
     // Can only clip non-reflex points.
 	const Vertices2& vertices = polygon.GetVertices();
-    if (IsVertexReflex(polygon, node)) {
+    if (IsInReflexSet(reflex, node)) {
         return false;
     }
 
-    // Check that no reflex points are inside this ear.
-	const TriangulateNode* const start = node.mNext->mNext;
-	const TriangulateNode* const end = node.mPrevious;
-    for (const TriangulateNode* p = start; p != end; p = p->mNext) {
-        // Only check reflex points.
-        if (!IsVertexReflex(polygon, *p)) {
-            continue;
-        }
+	// Test all reflex points against the ear's edges at once.
+	const U32 centerIndex = node.mIndex;
+	const U32 previousIndex = node.mPrevious->mIndex;
+	const U32 nextIndex = node.mNext->mIndex;
+	const Vector2& center = vertices[centerIndex];
+	const Vector2& previous = vertices[previousIndex];
+	const Vector2& next = vertices[nextIndex];
+	const U32 reflexCount = static_cast<U32>(reflex.mIndices.size());
+	const F32* x = reflex.mX.data();
+	const F32* y = reflex.mY.data();
+	I32* const orientationsA = reflex.mOrientations[0].data();
+	I32* const orientationsB = reflex.mOrientations[1].data();
+	I32* const orientationsC = reflex.mOrientations[2].data();
+	Predicates2::OrientBatch(center, previous, x, y, reflexCount, orientationsA);
+	Predicates2::OrientBatch(previous, next, x, y, reflexCount, orientationsB);
+	Predicates2::OrientBatch(next, center, x, y, reflexCount, orientationsC);
 
-        // Fail if we find one reflex inside the ear.
-        const U32 nodeIndex = p->mIndex;
-        const Vector2& vertex = vertices[nodeIndex];
-        if (IsVertexInEar(polygon, node, vertex)) {
-            return false;
-        }
-    }
-    return true;
+    // Fail if we find one reflex inside the ear or on its boundary, ignoring the ear's own vertices.
+    // The edges above run counter-clockwise around a convex ear, so no point inside is to their right.
+	const U32* indices = reflex.mIndices.data();
+	U32 insideCount = 0;
+	for (U32 i = 0; i < reflexCount; ++i) {
+		const bool notRightA = (orientationsA[i] >= 0);
+		const bool notRightB = (orientationsB[i] >= 0);
+		const bool notRightC = (orientationsC[i] >= 0);
+		const bool isEarVertex = (indices[i] == centerIndex) || (indices[i] == previousIndex) || (indices[i] == nextIndex);
+		const bool inside = notRightA && notRightB && notRightC && !isEarVertex;
+		insideCount += inside ? 1U : 0U;
+	}
+    return (insideCount == 0);
 }
 
 // Get the cosine of the smallest angle.
@@ -96,6 +180,13 @@ float Mesh2::GetMaximumCosine(const Polygon2& polygon, const TriangulateNode& no
     return result;
 }
 
+// Recompute a node's cached ear status and smallest angle.
+void Mesh2::UpdateEar(const Polygon2& polygon, TriangulateNode& node, ReflexVertices& reflex)
+{
+	node.mIsEar = CanRemoveEar(polygon, node, reflex);
+	node.mMaximumCosine = node.mIsEar ? GetMaximumCosine(polygon, node) : std::numeric_limits<F32>::max();
+}
+
 // Create a mesh from a polygon.
 void Mesh2::Triangulate()
 {
@@ -120,25 +211,42 @@ void Mesh2::Triangulate()
 		current.mPrevious = &nodes[previousIndex];
 	}
 
-    // Now start clipping ears.
+    // Find the ears of the whole polygon once.
 	TriangulateNode* head = &nodes.front();
+	ReflexVertices reflex;
+	GatherReflexVertices(mPolygon, head, count, reflex);
+	for (TriangulateNode& node : nodes) {
+		UpdateEar(mPolygon, node, reflex);
+	}
+
+    // Now start clipping ears.
     for (U32 clipsRemaining = triangleCount; clipsRemaining != 0; --clipsRemaining) {
         // Find the candidate with the largest minimum angle.
+        // Every remaining node is checked so slivers are avoided where possible.
+		const U32 nodesRemaining = clipsRemaining + Math::TriangleToVerticesOffset;
 		TriangulateNode* node = head;
-		std::tuple<float, TriangulateNode*> lowest = std::make_tuple(1.f, nullptr);
-        for (U32 c = clipsRemaining; c != 0; --c, node = node->mNext) {
-            if (CanRemoveEar(mPolygon, *node)) {
-                const float currentMaximumCosine = GetMaximumCosine(mPolygon, *node);
-                if (currentMaximumCosine <= std::get<F32>(lowest)) {
-					lowest = std::make_tuple(currentMaximumCosine, node);
-					break;
-                }
+		std::tuple<float, TriangulateNode*> lowest = std::make_tuple(std::numeric_limits<F32>::max(), nullptr);
+        for (U32 c = nodesRemaining; c != 0; --c, node = node->mNext) {
+            if (node->mIsEar && (node->mMaximumCosine <= std::get<F32>(lowest))) {
+				lowest = std::make_tuple(node->mMaximumCosine, node);
             }
         }
 
-        // Remove from list.
+        // A degenerate or self-touching outline may have no valid ear left.
+        // Clip the first convex vertex instead, or the head if there is none, so triangulation always completes.
 		TriangulateNode* lowestNode = std::get<TriangulateNode*>(lowest);
-        assert(lowestNode != nullptr);
+		if (lowestNode == nullptr) {
+			node = head;
+			for (U32 c = nodesRemaining; c != 0; --c, node = node->mNext) {
+				if (!IsInReflexSet(reflex, *node)) {
+					lowestNode = node;
+					break;
+				}
+			}
+			if (lowestNode == nullptr) {
+				lowestNode = head;
+			}
+		}
         TriangulateNode* next = lowestNode->mNext;
         TriangulateNode* previous = lowestNode->mPrevious;
         next->mPrevious = previous;
@@ -153,5 +261,15 @@ void Mesh2::Triangulate()
 		mIndices.push_back(previous->mIndex);
 		mIndices.push_back(lowestNode->mIndex);
 		mIndices.push_back(next->mIndex);
+
+		// Only the neighbours' reflex status and ear triangles changed.
+		// Other nodes keep their status: any vertex still inside their triangle implies a reflex one inside too.
+		RemoveReflexVertex(*lowestNode, reflex);
+		if (clipsRemaining > 1) {
+			UpdateReflexVertex(mPolygon, *previous, reflex);
+			UpdateReflexVertex(mPolygon, *next, reflex);
+			UpdateEar(mPolygon, *previous, reflex);
+			UpdateEar(mPolygon, *next, reflex);
+		}
     }
 }
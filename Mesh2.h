@@ -30,6 +30,24 @@ private:
 		U32 mIndex;
 		TriangulateNode* mNext;
 		TriangulateNode* mPrevious;
+
+		// Cached ear status and smallest angle; only a clipped node's neighbours need them updated.
+		bool mIsEar;
+		F32 mMaximumCosine;
+	};
+
+	// Reflex vertices of the remaining polygon, kept up to date for batch ear testing.
+	struct ReflexVertices
+	{
+		std::vector<F32> mX;
+		std::vector<F32> mY;
+		Indices mIndices;
+
+		// Position of each polygon vertex in the arrays above, if it's reflex.
+		Indices mSlots;
+
+		// Orientations against each ear edge.
+		std::vector<I32> mOrientations[Math::VerticesPerTriangle];
 	};
 
 	// Check which side of a 2D line segment a vertex is on.
@@ -38,15 +56,30 @@ private:
 	// Check if a given node represents a reflex polygon vertex.
 	static bool IsVertexReflex(const Polygon2& polygon, const TriangulateNode& node);
 
-	// Check if a given vertex is inside an ear centered at the given node.
-	static bool IsVertexInEar(const Polygon2& polygon, const TriangulateNode& node, const Vector2& vertex);
+	// Gather the reflex vertices of the whole polygon.
+	static void GatherReflexVertices(const Polygon2& polygon, const TriangulateNode* head, U32 count, ReflexVertices& reflex);
+
+	// Check if a node is in the reflex set.
+	static bool IsInReflexSet(const ReflexVertices& reflex, const TriangulateNode& node);
+
+	// Add a node's vertex to the reflex set.
+	static void AddReflexVertex(const Polygon2& polygon, const TriangulateNode& node, ReflexVertices& reflex);
+
+	// Remove a node's vertex from the reflex set if it's in it.
+	static void RemoveReflexVertex(const TriangulateNode& node, ReflexVertices& reflex);
+
+	// Add or remove a node's vertex from the reflex set after its neighbours changed.
+	static void UpdateReflexVertex(const Polygon2& polygon, const TriangulateNode& node, ReflexVertices& reflex);
 
 	// Check if an ear centered at the given node can be removed.
-	static bool CanRemoveEar(const Polygon2& polygon, const TriangulateNode& node);
+	static bool CanRemoveEar(const Polygon2& polygon, const TriangulateNode& node, ReflexVertices& reflex);
 
 	// Get the maximum cosine (smallest angle) in the ear triangle.
 	static float GetMaximumCosine(const Polygon2& polygon, const TriangulateNode& node);
 
+	// Recompute a node's cached ear status and smallest angle.
+	static void UpdateEar(const Polygon2& polygon, TriangulateNode& node, ReflexVertices& reflex);
+
 private:
 	Polygon2 mPolygon;
 	Indices mIndices;
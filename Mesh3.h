@@ -7,8 +7,13 @@ class Mesh3
 {
 public:
 	Mesh3() = default;
+	Mesh3(const Mesh3& mesh) = default;
+	Mesh3(Mesh3&& mesh) = default;
 	~Mesh3() = default;
 
+	Mesh3& operator=(const Mesh3& mesh) = default;
+	Mesh3& operator=(Mesh3&& mesh) = default;
+
 	// Allocate a mesh for a certain number of vertices/indices.
 	void Reserve(U32 vertexCount, U32 indexCount)
 	{
@@ -21,11 +26,24 @@ public:
 		mVertices.push_back(vertex);
 	}
 
+	// Overwrite an existing vertex in place.
+	inline void SetVertex(U32 index, const Vector3& vertex)
+	{
+		mVertices[index] = vertex;
+	}
+
 	inline void AddIndex(U32 index)
 	{
 		mIndices.push_back(index);
 	}
 
+	// Replace the vertex and index buffers, taking ownership of both.
+	inline void Assign(Vertices3&& vertices, Indices&& indices)
+	{
+		mVertices = std::move(vertices);
+		mIndices = std::move(indices);
+	}
+
 	inline const Vertices3& GetVertices() const
 	{
 		return mVertices;
@@ -36,6 +54,19 @@ public:
 		return mIndices;
 	}
 
+	// Remove all vertices and indices, keeping allocated memory.
+	inline void Clear()
+	{
+		mVertices.clear();
+		mIndices.clear();
+	}
+
+	// Get the number of bytes used by the vertex and index buffers.
+	inline size_t GetByteSize() const
+	{
+		return (mVertices.size() * sizeof(Vector3)) + (mIndices.size() * sizeof(U32));
+	}
+
 private:
 	Vertices3 mVertices;
 	Indices mIndices;
@@ -0,0 +1,181 @@
+#include "Common.h"
+#include "MeshCache.h"
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+	// Get the bit pattern of a float so keys hash and compare consistently.
+	inline U32 FloatBits(F32 value)
+	{
+		U32 bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// Use at least one shard, so the budget can be split without dividing by zero.
+	inline U32 ClampShardCount(U32 shardCount)
+	{
+		return (shardCount != 0) ? shardCount : 1U;
+	}
+}
+
+MeshCache::MeshCache(size_t byteBudget, U32 shardCount)
+	: mShards(new Shard[ClampShardCount(shardCount)])
+	, mShardCount(ClampShardCount(shardCount))
+	, mShardByteBudget(byteBudget / mShardCount)
+	, mHits(0)
+	, mMisses(0)
+	, mEvictions(0)
+{
+	for (U32 i = 0; i < mShardCount; ++i) {
+		mShards[i].mByteSize = 0;
+	}
+}
+
+// Get the mesh for a permutation, generating it on a miss.
+MeshCache::MeshHandle MeshCache::Acquire(const JigsawGenerator& generator, const JigsawMesh::Permutation& permutation)
+{
+	const Key key = MakeKey(generator, permutation);
+	const size_t hash = KeyHash()(key);
+	Shard& shard = GetShard(hash);
+
+	// Move to the front of the list on a hit.
+	{
+		std::lock_guard<std::mutex> lock(shard.mMutex);
+		const EntryMap::iterator found = shard.mLookup.find(key);
+		if (found != shard.mLookup.end()) {
+			shard.mEntries.splice(shard.mEntries.begin(), shard.mEntries, found->second);
+			mHits.fetch_add(1, std::memory_order_relaxed);
+			return found->second->mMesh;
+		}
+	}
+
+	// Generate outside the lock so other keys in this shard aren't blocked.
+	mMisses.fetch_add(1, std::memory_order_relaxed);
+	JigsawMesh jigsawMesh;
+	jigsawMesh.Generate(generator, permutation);
+	const MeshHandle mesh = std::make_shared<const Mesh3>(jigsawMesh.ReleaseMesh());
+	const size_t byteSize = mesh->GetByteSize();
+
+	// Don't cache meshes that could never fit.
+	if (byteSize > mShardByteBudget) {
+		return mesh;
+	}
+
+	std::lock_guard<std::mutex> lock(shard.mMutex);
+
+	// Another thread may have generated the same mesh in the meantime.
+	const EntryMap::iterator found = shard.mLookup.find(key);
+	if (found != shard.mLookup.end()) {
+		shard.mEntries.splice(shard.mEntries.begin(), shard.mEntries, found->second);
+		return found->second->mMesh;
+	}
+
+	const Entry entry = { key, mesh, byteSize };
+	shard.mEntries.push_front(entry);
+	shard.mLookup[key] = shard.mEntries.begin();
+	shard.mByteSize += byteSize;
+	EvictShard(shard);
+	return mesh;
+}
+
+// Get the current hit, miss and eviction counts.
+MeshCache::Statistics MeshCache::GetStatistics() const
+{
+	Statistics result;
+	result.mHits = mHits.load(std::memory_order_relaxed);
+	result.mMisses = mMisses.load(std::memory_order_relaxed);
+	result.mEvictions = mEvictions.load(std::memory_order_relaxed);
+	return result;
+}
+
+// Get the number of bytes currently held by cached meshes.
+size_t MeshCache::GetByteSize() const
+{
+	size_t result = 0;
+	for (U32 i = 0; i < mShardCount; ++i) {
+		Shard& shard = mShards[i];
+		std::lock_guard<std::mutex> lock(shard.mMutex);
+		result += shard.mByteSize;
+	}
+	return result;
+}
+
+// Remove all cached meshes.
+void MeshCache::Clear()
+{
+	for (U32 i = 0; i < mShardCount; ++i) {
+		Shard& shard = mShards[i];
+		std::lock_guard<std::mutex> lock(shard.mMutex);
+		shard.mLookup.clear();
+		shard.mEntries.clear();
+		shard.mByteSize = 0;
+	}
+}
+
+// Compare all generation parameters bit for bit.
+bool MeshCache::Key::operator==(const Key& other) const
+{
+	return (FloatBits(mWidth) == FloatBits(other.mWidth))
+		&& (FloatBits(mHeight) == FloatBits(other.mHeight))
+		&& (FloatBits(mCircleRadius) == FloatBits(other.mCircleRadius))
+		&& (mEndSegments == other.mEndSegments)
+		&& (mPermutation.mTop == other.mPermutation.mTop)
+		&& (mPermutation.mRight == other.mPermutation.mRight)
+		&& (mPermutation.mBottom == other.mPermutation.mBottom)
+		&& (mPermutation.mLeft == other.mPermutation.mLeft);
+}
+
+// Hash all generation parameters.
+size_t MeshCache::KeyHash::operator()(const Key& key) const
+{
+	U64 hash = Hash::FnvOffsetBasis;
+	hash = Hash::Combine(hash, FloatBits(key.mWidth));
+	hash = Hash::Combine(hash, FloatBits(key.mHeight));
+	hash = Hash::Combine(hash, FloatBits(key.mCircleRadius));
+	hash = Hash::Combine(hash, key.mEndSegments);
+
+	// Permutation end types fit in two bits each.
+	const JigsawMesh::Permutation& permutation = key.mPermutation;
+	const U32 packedPermutation = static_cast<U32>(permutation.mTop)
+		| (static_cast<U32>(permutation.mRight) << 2U)
+		| (static_cast<U32>(permutation.mBottom) << 4U)
+		| (static_cast<U32>(permutation.mLeft) << 6U);
+	hash = Hash::Combine(hash, packedPermutation);
+	return static_cast<size_t>(hash);
+}
+
+// Build the cache key for a generator and permutation.
+MeshCache::Key MeshCache::MakeKey(const JigsawGenerator& generator, const JigsawMesh::Permutation& permutation)
+{
+	Key result;
+	result.mWidth = generator.GetWidth();
+	result.mHeight = generator.GetHeight();
+	result.mCircleRadius = generator.GetCircleRadius();
+	result.mEndSegments = generator.GetEndSegments();
+	result.mPermutation = permutation;
+	return result;
+}
+
+// Get the shard responsible for a key hash.
+MeshCache::Shard& MeshCache::GetShard(size_t hash) const
+{
+	// Fold in the high bits so shard choice differs from the map's bucket choice.
+	const U64 wideHash = static_cast<U64>(hash);
+	const U32 index = static_cast<U32>((wideHash >> 32U) ^ wideHash) % mShardCount;
+	return mShards[index];
+}
+
+// Evict least recently used entries until the shard fits its budget.
+void MeshCache::EvictShard(Shard& shard)
+{
+	while (shard.mByteSize > mShardByteBudget) {
+		assert(!shard.mEntries.empty());
+		const Entry& last = shard.mEntries.back();
+		shard.mByteSize -= last.mByteSize;
+		shard.mLookup.erase(last.mKey);
+		shard.mEntries.pop_back();
+		mEvictions.fetch_add(1, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Common.h"
+#include "JigsawGenerator.h"
+#include "JigsawMesh.h"
+#include "Mesh3.h"
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Thread-safe cache of generated jigsaw meshes, bounded by a byte budget.
+// Meshes are keyed by the full set of generation parameters and evicted in least recently used order.
+class MeshCache
+{
+public:
+	// Shared handle to an immutable cached mesh.
+	using MeshHandle = std::shared_ptr<const Mesh3>;
+
+	// Snapshot of cache counters.
+	struct Statistics
+	{
+		U64 mHits;
+		U64 mMisses;
+		U64 mEvictions;
+	};
+
+public:
+	// Split the byte budget evenly over a number of shards; a shard count of zero is treated as one.
+	MeshCache(size_t byteBudget, U32 shardCount = DefaultShardCount);
+	~MeshCache() = default;
+
+	// Get the mesh for a permutation with the given generator's parameters, generating it on a miss.
+	MeshHandle Acquire(const JigsawGenerator& generator, const JigsawMesh::Permutation& permutation);
+
+	// Get the current hit, miss and eviction counts.
+	Statistics GetStatistics() const;
+
+	// Get the number of bytes currently held by cached meshes.
+	size_t GetByteSize() const;
+
+	// Remove all cached meshes.
+	void Clear();
+
+public:
+	static constexpr U32 DefaultShardCount = 16U;
+
+private:
+	// Full set of parameters that determine a generated mesh.
+	struct Key
+	{
+		F32 mWidth;
+		F32 mHeight;
+		F32 mCircleRadius;
+		U32 mEndSegments;
+		JigsawMesh::Permutation mPermutation;
+
+		bool operator==(const Key& other) const;
+	};
+
+	// Hasher for cache keys.
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	// Cached mesh with its size.
+	struct Entry
+	{
+		Key mKey;
+		MeshHandle mMesh;
+		size_t mByteSize;
+	};
+
+	// Entries are kept in most recently used order.
+	using Entries = std::list<Entry>;
+	using EntryMap = std::unordered_map<Key, Entries::iterator, KeyHash>;
+
+	// Independently locked partition of the cache.
+	struct Shard
+	{
+		std::mutex mMutex;
+		Entries mEntries;
+		EntryMap mLookup;
+		size_t mByteSize;
+	};
+
+private:
+	// Build the cache key for a generator and permutation.
+	static Key MakeKey(const JigsawGenerator& generator, const JigsawMesh::Permutation& permutation);
+
+	// Get the shard responsible for a key hash.
+	Shard& GetShard(size_t hash) const;
+
+	// Evict least recently used entries until the shard fits its budget.
+	// Assumes the shard's mutex is held.
+	void EvictShard(Shard& shard);
+
+private:
+	std::unique_ptr<Shard[]> mShards;
+	U32 mShardCount;
+	size_t mShardByteBudget;
+
+	// Cache counters.
+	std::atomic<U64> mHits;
+	std::atomic<U64> mMisses;
+	std::atomic<U64> mEvictions;
+};
@@ -15,6 +15,12 @@ public:
 		mVertices.reserve(vertexCount);
 	}
 
+	// Remove all vertices, keeping allocated memory.
+	inline void Clear()
+	{
+		mVertices.clear();
+	}
+
 	inline void AddVertex(const Vector2& vertex)
 	{
 		mVertices.push_back(vertex);
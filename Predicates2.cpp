@@ -0,0 +1,121 @@
+#include "Common.h"
+#include "Predicates2.h"
+#include <cmath>
+
+namespace
+{
+	// Relative error bound of the float determinant, from Shewchuk's orient2d analysis with epsilon = 2^-24.
+	static constexpr F32 Epsilon = 1.f / 16777216.f;
+	static constexpr F32 RelativeErrorBound = (3.f + (16.f * Epsilon)) * Epsilon;
+
+	// Absolute error bound covering products that underflow into subnormals.
+	static constexpr F32 UnderflowErrorBound = 1e-43f;
+
+	// Number of products in the expanded determinant.
+	static constexpr U32 ProductCount = 6U;
+
+	// Filtered float determinant; returns 0 when the sign can't be trusted.
+	inline I32 OrientFiltered(F32 ax, F32 ay, F32 bx, F32 by, F32 cx, F32 cy)
+	{
+		const F32 detLeft = (ax - cx) * (by - cy);
+		const F32 detRight = (ay - cy) * (bx - cx);
+		const F32 det = detLeft - detRight;
+		const F32 errorBound = (RelativeErrorBound * (fabsf(detLeft) + fabsf(detRight))) + UnderflowErrorBound;
+		return static_cast<I32>(det > errorBound) - static_cast<I32>(det < -errorBound);
+	}
+
+	// Sum two doubles, returning the rounded sum and its exact rounding error.
+	inline void TwoSum(double a, double b, double& sum, double& error)
+	{
+		sum = a + b;
+		const double bVirtual = sum - a;
+		const double aVirtual = sum - bVirtual;
+		const double bRoundoff = b - bVirtual;
+		const double aRoundoff = a - aVirtual;
+		error = aRoundoff + bRoundoff;
+	}
+
+	// Add a double to a nonoverlapping expansion of increasing magnitude, dropping zero components.
+	// Returns the new component count.
+	inline U32 GrowExpansion(double* expansion, U32 count, double value)
+	{
+		double carry = value;
+		U32 result = 0;
+		for (U32 i = 0; i < count; ++i) {
+			double sum;
+			double error;
+			TwoSum(carry, expansion[i], sum, error);
+			if (error != 0.0) {
+				expansion[result++] = error;
+			}
+			carry = sum;
+		}
+		if (carry != 0.0) {
+			expansion[result++] = carry;
+		}
+		return result;
+	}
+}
+
+// Get the orientation of point c relative to the directed line from a to b.
+I32 Predicates2::Orient(const Vector2& a, const Vector2& b, const Vector2& c)
+{
+	const I32 filtered = OrientFiltered(a.x, a.y, b.x, b.y, c.x, c.y);
+	if (filtered != 0) {
+		return filtered;
+	}
+	return OrientExact(a, b, c);
+}
+
+// Get the exact orientation without the float filter.
+// Products of two floats are exact in double precision, so the determinant is an exact sum of six terms.
+I32 Predicates2::OrientExact(const Vector2& a, const Vector2& b, const Vector2& c)
+{
+	const double ax = a.x;
+	const double ay = a.y;
+	const double bx = b.x;
+	const double by = b.y;
+	const double cx = c.x;
+	const double cy = c.y;
+	const double products[ProductCount] = {
+		ax * by,
+		-(ax * cy),
+		-(cx * by),
+		-(ay * bx),
+		ay * cx,
+		cy * bx
+	};
+
+	double expansion[ProductCount];
+	U32 count = 0;
+	for (const double product : products) {
+		count = GrowExpansion(expansion, count, product);
+	}
+
+	// The largest component determines the sign.
+	if (count == 0) {
+		return 0;
+	}
+	const double largest = expansion[count - 1];
+	return (largest > 0.0) ? 1 : -1;
+}
+
+// Get the orientation of many points relative to the directed line from a to b.
+void Predicates2::OrientBatch(const Vector2& a, const Vector2& b, const F32* x, const F32* y, U32 count, I32* orientations)
+{
+	// Filter all points first; this loop has no branches so it vectorizes.
+	const F32 ax = a.x;
+	const F32 ay = a.y;
+	const F32 bx = b.x;
+	const F32 by = b.y;
+	for (U32 i = 0; i < count; ++i) {
+		orientations[i] = OrientFiltered(ax, ay, bx, by, x[i], y[i]);
+	}
+
+	// Resolve the rare ambiguous points exactly.
+	for (U32 i = 0; i < count; ++i) {
+		if (orientations[i] == 0) {
+			orientations[i] = OrientExact(a, b, Vector2(x[i], y[i]));
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Common.h"
+
+// Robust two dimensional geometric predicates.
+// A float evaluation with an error bound answers almost all queries; only ambiguous ones are computed exactly.
+namespace Predicates2
+{
+	// Get the orientation of point c relative to the directed line from a to b.
+	// Returns 1 if c is to the left, -1 if to the right, and 0 only if the points are exactly collinear.
+	I32 Orient(const Vector2& a, const Vector2& b, const Vector2& c);
+
+	// Get the exact orientation without the float filter.
+	I32 OrientExact(const Vector2& a, const Vector2& b, const Vector2& c);
+
+	// Get the orientation of many points relative to the directed line from a to b.
+	// Points are given as separate coordinate arrays so the filter loop vectorizes.
+	void OrientBatch(const Vector2& a, const Vector2& b, const F32* x, const F32* y, U32 count, I32* orientations);
+}
@@ -0,0 +1,317 @@
+#include "Common.h"
+#include "QuantizedMesh3.h"
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+	// Number of payload bits in each variable length byte; the high bit marks that more bytes follow.
+	static constexpr U32 VarintPayloadBits = 7U;
+	static constexpr U8 VarintContinue = 0x80U;
+	static constexpr U8 VarintPayloadMask = 0x7FU;
+
+	// Longest variable length encoding of a 32-bit value.
+	static constexpr U32 MaximumVarintBytes = 5U;
+
+	// Map a signed delta to an unsigned value with small magnitudes staying small.
+	inline U32 ZigzagEncode(U32 delta)
+	{
+		return (delta << 1) ^ static_cast<U32>(static_cast<I32>(delta) >> 31);
+	}
+
+	// Recover a signed delta from its zigzag value.
+	inline U32 ZigzagDecode(U32 value)
+	{
+		return (value >> 1) ^ (0U - (value & 1U));
+	}
+
+	// Append a value as variable length bytes.
+	inline void WriteVarint(U32 value, std::vector<U8>& output)
+	{
+		while (value >= VarintContinue) {
+			output.push_back(static_cast<U8>(value) | VarintContinue);
+			value >>= VarintPayloadBits;
+		}
+		output.push_back(static_cast<U8>(value));
+	}
+
+	// Read a value from variable length bytes known to be well formed.
+	inline U32 ReadVarint(const U8*& input)
+	{
+		// Most deltas in a triangle list fit in one byte.
+		U32 byte = *input++;
+		if (byte < VarintContinue) {
+			return byte;
+		}
+
+		U32 value = byte & VarintPayloadMask;
+		U32 shift = VarintPayloadBits;
+		do {
+			byte = *input++;
+			value |= (byte & VarintPayloadMask) << shift;
+			shift += VarintPayloadBits;
+		} while (byte >= VarintContinue);
+		return value;
+	}
+
+	// Map a coordinate to its fixed point value.
+	inline U16 Quantize(F32 value, F32 minimum, F32 inverseScale)
+	{
+		const F32 scaled = ((value - minimum) * inverseScale) + 0.5f;
+		return static_cast<U16>(Math::Clamp(scaled, 0.f, 65535.f));
+	}
+
+	// Append raw bytes of an array to a byte stream.
+	template <typename Type>
+	inline void WriteArray(const std::vector<Type>& values, std::vector<U8>& output)
+	{
+		const size_t byteSize = values.size() * sizeof(Type);
+		const size_t offset = output.size();
+		output.resize(offset + byteSize);
+		if (byteSize != 0) {
+			memcpy(output.data() + offset, values.data(), byteSize);
+		}
+	}
+
+	// Read raw bytes of an array of a known count from a byte stream.
+	template <typename Type>
+	inline void ReadArray(const U8* data, size_t count, std::vector<Type>& values)
+	{
+		values.resize(count);
+		if (count != 0) {
+			memcpy(values.data(), data, count * sizeof(Type));
+		}
+	}
+}
+
+QuantizedMesh3::QuantizedMesh3()
+	: mMinimum(Math::Zero2)
+	, mScale(Math::Zero2)
+	, mFrontZ(0.f)
+	, mBackZ(0.f)
+	, mVertexCount(0)
+	, mIndexCount(0)
+{
+}
+
+// Quantize a mesh's vertices to its bounds and delta encode its indices.
+bool QuantizedMesh3::Encode(const Mesh3& mesh)
+{
+	Clear();
+	const Vertices3& vertices = mesh.GetVertices();
+	const Indices& indices = mesh.GetIndices();
+	if (vertices.empty()) {
+		assert(indices.empty());
+		return true;
+	}
+
+	// Find the bounds and the two depths.
+	Vector2 minimum(vertices[0].x, vertices[0].y);
+	Vector2 maximum = minimum;
+	F32 frontZ = vertices[0].z;
+	F32 backZ = vertices[0].z;
+	for (const Vector3& vertex : vertices) {
+		minimum.x = (vertex.x < minimum.x) ? vertex.x : minimum.x;
+		minimum.y = (vertex.y < minimum.y) ? vertex.y : minimum.y;
+		maximum.x = Math::Maximum(maximum.x, vertex.x);
+		maximum.y = Math::Maximum(maximum.y, vertex.y);
+		if ((vertex.z == frontZ) || (vertex.z == backZ)) {
+			continue;
+		}
+
+		// A third depth can't be stored in one bit.
+		if (frontZ != backZ) {
+			return false;
+		}
+		frontZ = Math::Maximum(backZ, vertex.z);
+		backZ = (frontZ == vertex.z) ? backZ : vertex.z;
+	}
+
+	// Flat extents quantize everything to zero.
+	const Vector2 extent = maximum - minimum;
+	mMinimum = minimum;
+	mScale = Vector2(extent.x / QuantizedRange, extent.y / QuantizedRange);
+	const F32 inverseX = (extent.x > 0.f) ? (QuantizedRange / extent.x) : 0.f;
+	const F32 inverseY = (extent.y > 0.f) ? (QuantizedRange / extent.y) : 0.f;
+	mFrontZ = frontZ;
+	mBackZ = backZ;
+
+	mVertexCount = static_cast<U32>(vertices.size());
+	mX.resize(mVertexCount);
+	mY.resize(mVertexCount);
+	mDepths.assign(CalculateDepthWordCount(mVertexCount), 0U);
+	for (U32 i = 0; i < mVertexCount; ++i) {
+		const Vector3& vertex = vertices[i];
+		mX[i] = Quantize(vertex.x, minimum.x, inverseX);
+		mY[i] = Quantize(vertex.y, minimum.y, inverseY);
+		if ((vertex.z == frontZ) && (frontZ != backZ)) {
+			mDepths[i / DepthsPerWord] |= 1U << (i % DepthsPerWord);
+		}
+	}
+
+	// Consecutive indices are usually close, so their differences take one or two bytes.
+	mIndexCount = static_cast<U32>(indices.size());
+	mIndexBytes.reserve(indices.size() + (indices.size() / 2));
+	U32 previous = 0;
+	for (const U32 index : indices) {
+		assert(index < mVertexCount);
+		WriteVarint(ZigzagEncode(index - previous), mIndexBytes);
+		previous = index;
+	}
+	mIndexBytes.shrink_to_fit();
+	return true;
+}
+
+// Decode into a mesh, replacing its contents.
+void QuantizedMesh3::Decode(Mesh3& mesh) const
+{
+	Vertices3 vertices(mVertexCount);
+	Indices indices(mIndexCount);
+	DecodeVertices(vertices.data());
+	DecodeIndices(indices.data());
+	mesh.Assign(std::move(vertices), std::move(indices));
+}
+
+// Decode all vertices; the loop has no branches so it vectorizes.
+void QuantizedMesh3::DecodeVertices(Vector3* vertices) const
+{
+	const U16* x = mX.data();
+	const U16* y = mY.data();
+	const U32* depths = mDepths.data();
+	const F32 minimumX = mMinimum.x;
+	const F32 minimumY = mMinimum.y;
+	const F32 scaleX = mScale.x;
+	const F32 scaleY = mScale.y;
+	const F32 frontZ = mFrontZ;
+	const F32 backZ = mBackZ;
+	for (U32 i = 0; i < mVertexCount; ++i) {
+		const bool isFront = ((depths[i / DepthsPerWord] >> (i % DepthsPerWord)) & 1U) != 0;
+		vertices[i].x = minimumX + (static_cast<F32>(x[i]) * scaleX);
+		vertices[i].y = minimumY + (static_cast<F32>(y[i]) * scaleY);
+		vertices[i].z = isFront ? frontZ : backZ;
+	}
+}
+
+// Decode all indices by summing their deltas.
+void QuantizedMesh3::DecodeIndices(U32* indices) const
+{
+	const U8* input = mIndexBytes.data();
+	U32 previous = 0;
+	for (U32 i = 0; i < mIndexCount; ++i) {
+		previous += ZigzagDecode(ReadVarint(input));
+		indices[i] = previous;
+	}
+	assert(input == (mIndexBytes.data() + mIndexBytes.size()));
+}
+
+// Append the archive header followed by the raw buffers.
+// Values are written in the machine's byte order.
+void QuantizedMesh3::Write(std::vector<U8>& output) const
+{
+	ArchiveHeader header;
+	header.mMagic = ArchiveMagic;
+	header.mVersion = ArchiveVersion;
+	header.mMinimum = mMinimum;
+	header.mScale = mScale;
+	header.mFrontZ = mFrontZ;
+	header.mBackZ = mBackZ;
+	header.mVertexCount = mVertexCount;
+	header.mIndexCount = mIndexCount;
+	header.mIndexByteCount = static_cast<U32>(mIndexBytes.size());
+
+	const size_t offset = output.size();
+	output.resize(offset + sizeof(header));
+	memcpy(output.data() + offset, &header, sizeof(header));
+	WriteArray(mX, output);
+	WriteArray(mY, output);
+	WriteArray(mDepths, output);
+	WriteArray(mIndexBytes, output);
+}
+
+// Read a mesh from its archive layout, checking sizes and indices so bad data can't be decoded out of bounds.
+size_t QuantizedMesh3::Read(const U8* data, size_t byteSize)
+{
+	Clear();
+	ArchiveHeader header;
+	if (byteSize < sizeof(header)) {
+		return 0;
+	}
+	memcpy(&header, data, sizeof(header));
+	if ((header.mMagic != ArchiveMagic) || (header.mVersion != ArchiveVersion)) {
+		return 0;
+	}
+
+	// Check the buffers fit before reading any of them.
+	const U64 vertexCount = header.mVertexCount;
+	const U64 depthWordCount = CalculateDepthWordCount(header.mVertexCount);
+	const U64 totalByteSize = sizeof(header) +
+		(vertexCount * sizeof(U16) * 2U) +
+		(depthWordCount * sizeof(U32)) +
+		header.mIndexByteCount;
+	if (totalByteSize > byteSize) {
+		return 0;
+	}
+
+	const U8* input = data + sizeof(header);
+	ReadArray(input, header.mVertexCount, mX);
+	input += vertexCount * sizeof(U16);
+	ReadArray(input, header.mVertexCount, mY);
+	input += vertexCount * sizeof(U16);
+	ReadArray(input, static_cast<size_t>(depthWordCount), mDepths);
+	input += depthWordCount * sizeof(U32);
+	ReadArray(input, header.mIndexByteCount, mIndexBytes);
+
+	mMinimum = header.mMinimum;
+	mScale = header.mScale;
+	mFrontZ = header.mFrontZ;
+	mBackZ = header.mBackZ;
+	mVertexCount = header.mVertexCount;
+	mIndexCount = header.mIndexCount;
+	if (!AreIndicesValid()) {
+		Clear();
+		return 0;
+	}
+	return static_cast<size_t>(totalByteSize);
+}
+
+// Remove all vertices and indices.
+void QuantizedMesh3::Clear()
+{
+	mMinimum = Math::Zero2;
+	mScale = Math::Zero2;
+	mFrontZ = 0.f;
+	mBackZ = 0.f;
+	mVertexCount = 0;
+	mIndexCount = 0;
+	mX.clear();
+	mY.clear();
+	mDepths.clear();
+	mIndexBytes.clear();
+}
+
+// Check that encoded indices decode to exactly the index count, all within the vertices.
+bool QuantizedMesh3::AreIndicesValid() const
+{
+	const U8* input = mIndexBytes.data();
+	const U8* end = input + mIndexBytes.size();
+	U32 previous = 0;
+	for (U32 i = 0; i < mIndexCount; ++i) {
+		U32 value = 0;
+		U32 byteCount = 0;
+		U32 byte = VarintContinue;
+		while (byte >= VarintContinue) {
+			if ((input == end) || (byteCount == MaximumVarintBytes)) {
+				return false;
+			}
+			byte = *input++;
+			value |= (byte & VarintPayloadMask) << (byteCount * VarintPayloadBits);
+			++byteCount;
+		}
+
+		previous += ZigzagDecode(value);
+		if (previous >= mVertexCount) {
+			return false;
+		}
+	}
+	return (input == end);
+}
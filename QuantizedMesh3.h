@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Common.h"
+#include "Mesh3.h"
+
+// Compact storage for a piece mesh, for long-lived caches and archives.
+// x/y are 16-bit fixed point inside the mesh bounds, z is a single bit choosing between the front and back depth,
+// and indices are stored as zigzag-encoded deltas in variable length bytes.
+class QuantizedMesh3
+{
+public:
+	QuantizedMesh3();
+	QuantizedMesh3(const QuantizedMesh3& mesh) = default;
+	QuantizedMesh3(QuantizedMesh3&& mesh) = default;
+	~QuantizedMesh3() = default;
+
+	QuantizedMesh3& operator=(const QuantizedMesh3& mesh) = default;
+	QuantizedMesh3& operator=(QuantizedMesh3&& mesh) = default;
+
+	// Quantize a mesh.
+	// Returns false if its vertices use more than two depths.
+	bool Encode(const Mesh3& mesh);
+
+	// Decode into a mesh, replacing its contents.
+	void Decode(Mesh3& mesh) const;
+
+	// Decode all vertices into an array of the vertex count.
+	void DecodeVertices(Vector3* vertices) const;
+
+	// Decode all indices into an array of the index count.
+	void DecodeIndices(U32* indices) const;
+
+	// Append the mesh in its archive layout to a byte stream.
+	void Write(std::vector<U8>& output) const;
+
+	// Read a mesh from its archive layout.
+	// Returns the number of bytes read, or zero if the data is truncated or malformed.
+	size_t Read(const U8* data, size_t byteSize);
+
+	// Remove all vertices and indices.
+	void Clear();
+
+	inline U32 GetVertexCount() const
+	{
+		return mVertexCount;
+	}
+
+	inline U32 GetIndexCount() const
+	{
+		return mIndexCount;
+	}
+
+	// Get the largest distance between a decoded coordinate and the original.
+	inline F32 GetMaximumError() const
+	{
+		return 0.5f * Math::Maximum(mScale.x, mScale.y);
+	}
+
+	// Get the number of bytes used by the quantized buffers.
+	inline size_t GetByteSize() const
+	{
+		return (mX.size() * sizeof(U16)) + (mY.size() * sizeof(U16)) + (mDepths.size() * sizeof(U32)) + mIndexBytes.size();
+	}
+
+private:
+	// Number of steps in the fixed point range of a coordinate.
+	static constexpr F32 QuantizedRange = 65535.f;
+
+	// Number of depth flags packed in each word.
+	static constexpr U32 DepthsPerWord = 32U;
+
+	// Identifies the archive layout and its version.
+	static constexpr U32 ArchiveMagic = 0x334D514AU;
+	static constexpr U32 ArchiveVersion = 1U;
+
+	// Fixed size part of the archive layout; the buffers follow it in declaration order.
+	struct ArchiveHeader
+	{
+		U32 mMagic;
+		U32 mVersion;
+		Vector2 mMinimum;
+		Vector2 mScale;
+		F32 mFrontZ;
+		F32 mBackZ;
+		U32 mVertexCount;
+		U32 mIndexCount;
+		U32 mIndexByteCount;
+	};
+
+private:
+	// Get the number of words needed for a number of depth flags.
+	static inline U32 CalculateDepthWordCount(U32 vertexCount)
+	{
+		return (vertexCount + DepthsPerWord - 1) / DepthsPerWord;
+	}
+
+	// Check that encoded indices decode to exactly the index count, all within the vertices.
+	bool AreIndicesValid() const;
+
+private:
+	// Bounds of the original vertices: coordinates decode as minimum + (value * scale).
+	Vector2 mMinimum;
+	Vector2 mScale;
+
+	// Depths selected by set and cleared depth flags.
+	F32 mFrontZ;
+	F32 mBackZ;
+
+	U32 mVertexCount;
+	U32 mIndexCount;
+
+	// Coordinates are kept in separate arrays so decoding vectorizes.
+	std::vector<U16> mX;
+	std::vector<U16> mY;
+	std::vector<U32> mDepths;
+	std::vector<U8> mIndexBytes;
+};
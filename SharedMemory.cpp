@@ -0,0 +1,220 @@
+#include "Common.h"
+#include "SharedMemory.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemory::SharedMemory()
+	: mData(nullptr)
+	, mByteSize(0)
+	, mOwner(false)
+#ifdef _WIN32
+	, mMapping(nullptr)
+#endif
+{
+}
+
+SharedMemory::SharedMemory(SharedMemory&& memory)
+	: SharedMemory()
+{
+	*this = std::move(memory);
+}
+
+SharedMemory::~SharedMemory()
+{
+	Close();
+}
+
+SharedMemory& SharedMemory::operator=(SharedMemory&& memory)
+{
+	if (this != &memory) {
+		Close();
+		mName = std::move(memory.mName);
+		mData = memory.mData;
+		mByteSize = memory.mByteSize;
+		mOwner = memory.mOwner;
+		memory.mData = nullptr;
+		memory.mByteSize = 0;
+		memory.mOwner = false;
+#ifdef _WIN32
+		mMapping = memory.mMapping;
+		memory.mMapping = nullptr;
+#endif
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+
+// Create a new zero-filled segment and map it.
+bool SharedMemory::Create(const std::string& name, size_t byteSize)
+{
+	Close();
+
+	// Windows names can't contain slashes outside of a namespace prefix.
+	const std::string mappingName = (!name.empty() && (name[0] == '/')) ? name.substr(1) : name;
+	const U64 size = static_cast<U64>(byteSize);
+	HANDLE mapping = CreateFileMappingA(
+		INVALID_HANDLE_VALUE,
+		nullptr,
+		PAGE_READWRITE,
+		static_cast<DWORD>(size >> 32),
+		static_cast<DWORD>(size & 0xFFFFFFFFULL),
+		mappingName.c_str());
+	if (mapping == nullptr) {
+		return false;
+	}
+	if (GetLastError() == ERROR_ALREADY_EXISTS) {
+		CloseHandle(mapping);
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, byteSize);
+	if (data == nullptr) {
+		CloseHandle(mapping);
+		return false;
+	}
+
+	mName = name;
+	mData = data;
+	mByteSize = byteSize;
+	mOwner = true;
+	mMapping = mapping;
+	return true;
+}
+
+// Map an existing segment created by another process.
+bool SharedMemory::Open(const std::string& name)
+{
+	Close();
+
+	const std::string mappingName = (!name.empty() && (name[0] == '/')) ? name.substr(1) : name;
+	HANDLE mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, mappingName.c_str());
+	if (mapping == nullptr) {
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (data == nullptr) {
+		CloseHandle(mapping);
+		return false;
+	}
+
+	// The view covers the whole section, rounded up to pages.
+	MEMORY_BASIC_INFORMATION information;
+	if (VirtualQuery(data, &information, sizeof(information)) == 0) {
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+		return false;
+	}
+
+	mName = name;
+	mData = data;
+	mByteSize = information.RegionSize;
+	mOwner = false;
+	mMapping = mapping;
+	return true;
+}
+
+// Unmap the segment.
+// Windows removes the section when the last handle closes, so owners have nothing extra to do.
+void SharedMemory::Close()
+{
+	if (mData != nullptr) {
+		UnmapViewOfFile(mData);
+		CloseHandle(mMapping);
+	}
+	mName.clear();
+	mData = nullptr;
+	mByteSize = 0;
+	mOwner = false;
+	mMapping = nullptr;
+}
+
+#else
+
+// Create a new zero-filled segment and map it.
+bool SharedMemory::Create(const std::string& name, size_t byteSize)
+{
+	Close();
+
+	const int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	if (descriptor < 0) {
+		return false;
+	}
+	if (ftruncate(descriptor, static_cast<off_t>(byteSize)) != 0) {
+		close(descriptor);
+		shm_unlink(name.c_str());
+		return false;
+	}
+
+	void* data = mmap(nullptr, byteSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (data == MAP_FAILED) {
+		shm_unlink(name.c_str());
+		return false;
+	}
+
+	mName = name;
+	mData = data;
+	mByteSize = byteSize;
+	mOwner = true;
+	return true;
+}
+
+// Map an existing segment created by another process.
+bool SharedMemory::Open(const std::string& name)
+{
+	Close();
+
+	const int descriptor = shm_open(name.c_str(), O_RDWR, 0);
+	if (descriptor < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if ((fstat(descriptor, &status) != 0) || (status.st_size <= 0)) {
+		close(descriptor);
+		return false;
+	}
+
+	const size_t byteSize = static_cast<size_t>(status.st_size);
+	void* data = mmap(nullptr, byteSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+	mName = name;
+	mData = data;
+	mByteSize = byteSize;
+	mOwner = false;
+	return true;
+}
+
+// Unmap the segment, removing its name if this created it.
+// Processes that still have it mapped keep their mapping.
+void SharedMemory::Close()
+{
+	if (mData != nullptr) {
+		munmap(mData, mByteSize);
+		if (mOwner) {
+			shm_unlink(mName.c_str());
+		}
+	}
+	mName.clear();
+	mData = nullptr;
+	mByteSize = 0;
+	mOwner = false;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Common.h"
+#include <string>
+
+// Named memory segment that can be mapped by several processes.
+// Uses POSIX shared memory, or a pagefile-backed file mapping on Windows.
+class SharedMemory
+{
+public:
+	SharedMemory();
+	SharedMemory(const SharedMemory& memory) = delete;
+	SharedMemory(SharedMemory&& memory);
+	~SharedMemory();
+
+	SharedMemory& operator=(const SharedMemory& memory) = delete;
+	SharedMemory& operator=(SharedMemory&& memory);
+
+	// Create a new zero-filled segment and map it.
+	// The name must start with a slash and have no other slashes to be portable.
+	// The segment's name is removed again when the creator closes it.
+	bool Create(const std::string& name, size_t byteSize);
+
+	// Map an existing segment created by another process.
+	bool Open(const std::string& name);
+
+	// Unmap the segment, removing its name if this created it.
+	void Close();
+
+	// Check whether a segment is mapped.
+	inline bool IsOpen() const
+	{
+		return (mData != nullptr);
+	}
+
+	// Get the start of the mapped segment.
+	inline void* GetData() const
+	{
+		return mData;
+	}
+
+	// Get the number of bytes mapped.
+	inline size_t GetByteSize() const
+	{
+		return mByteSize;
+	}
+
+private:
+	std::string mName;
+	void* mData;
+	size_t mByteSize;
+	bool mOwner;
+
+#ifdef _WIN32
+	void* mMapping;
+#endif
+};
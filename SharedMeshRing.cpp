@@ -0,0 +1,319 @@
+#include "Common.h"
+#include "SharedMeshRing.h"
+#include <new>
+
+namespace
+{
+	// Round a byte count up to a whole number of cache lines.
+	inline size_t AlignToCacheLine(size_t byteSize)
+	{
+		return (byteSize + SharedMeshRing::CacheLineSize - 1) & ~(SharedMeshRing::CacheLineSize - 1);
+	}
+
+	// Get the offset of a slot's vertices from its header.
+	inline size_t GetVertexOffset()
+	{
+		return AlignToCacheLine(sizeof(SharedMeshRing::SlotHeader));
+	}
+
+	// Get the offset of a slot's indices from its header.
+	inline size_t GetIndexOffset(U32 vertexCapacity)
+	{
+		return GetVertexOffset() + (static_cast<size_t>(vertexCapacity) * sizeof(Vector3));
+	}
+
+	// Get a slot's vertices.
+	inline Vector3* GetSlotVertices(const SharedMeshRing::SlotHeader* slot)
+	{
+		const char* bytes = reinterpret_cast<const char*>(slot);
+		return reinterpret_cast<Vector3*>(const_cast<char*>(bytes + GetVertexOffset()));
+	}
+
+	// Get a slot's indices.
+	inline U32* GetSlotIndices(const SharedMeshRing::SlotHeader* slot, U32 vertexCapacity)
+	{
+		const char* bytes = reinterpret_cast<const char*>(slot);
+		return reinterpret_cast<U32*>(const_cast<char*>(bytes + GetIndexOffset(vertexCapacity)));
+	}
+
+	// Get the generation a slot has while a mesh is being written to it.
+	inline U64 GetWritingGeneration(U64 sequence)
+	{
+		return (sequence * 2U) + 1U;
+	}
+
+	// Get the generation a slot has once a mesh is published in it.
+	inline U64 GetPublishedGeneration(U64 sequence)
+	{
+		return (sequence * 2U) + 2U;
+	}
+}
+
+// Get the number of bytes for one slot.
+size_t SharedMeshRing::CalculateSlotByteSize(U32 vertexCapacity, U32 indexCapacity)
+{
+	const size_t indexOffset = GetIndexOffset(vertexCapacity);
+	return AlignToCacheLine(indexOffset + (static_cast<size_t>(indexCapacity) * sizeof(U32)));
+}
+
+// Get the number of bytes for a whole ring segment.
+size_t SharedMeshRing::CalculateByteSize(U32 slotCount, U32 vertexCapacity, U32 indexCapacity)
+{
+	const size_t headerByteSize = AlignToCacheLine(sizeof(Header));
+	return headerByteSize + (static_cast<size_t>(slotCount) * CalculateSlotByteSize(vertexCapacity, indexCapacity));
+}
+
+// Check that the header's counters are lock free, so they work across processes.
+// Slot generations use the same type as the head and tail counters.
+bool SharedMeshRing::IsLockFree(const Header& header)
+{
+	return header.mMagic.is_lock_free() && header.mHead.is_lock_free() && header.mTail.is_lock_free();
+}
+
+SharedMeshPublisher::SharedMeshPublisher()
+	: mHeader(nullptr)
+	, mSlot(nullptr)
+	, mVertices(nullptr)
+	, mIndices(nullptr)
+	, mVertexCount(0)
+	, mIndexCount(0)
+	, mVertexReserved(0)
+	, mIndexReserved(0)
+{
+}
+
+// Create a named ring and initialize its header and slots.
+bool SharedMeshPublisher::Create(const std::string& name, U32 slotCount, U32 vertexCapacity, U32 indexCapacity)
+{
+	assert(slotCount != 0);
+	Close();
+
+	const size_t byteSize = SharedMeshRing::CalculateByteSize(slotCount, vertexCapacity, indexCapacity);
+	if (!mMemory.Create(name, byteSize)) {
+		return false;
+	}
+
+	// The segment starts zeroed; construct the counters in place.
+	mHeader = new (mMemory.GetData()) SharedMeshRing::Header;
+	if (!SharedMeshRing::IsLockFree(*mHeader)) {
+		Close();
+		return false;
+	}
+	mHeader->mVersion = SharedMeshRing::Version;
+	mHeader->mSlotCount = slotCount;
+	mHeader->mVertexCapacity = vertexCapacity;
+	mHeader->mIndexCapacity = indexCapacity;
+	mHeader->mSlotByteSize = SharedMeshRing::CalculateSlotByteSize(vertexCapacity, indexCapacity);
+	mHeader->mHead.store(0, std::memory_order_relaxed);
+	mHeader->mTail.store(0, std::memory_order_relaxed);
+	for (U32 i = 0; i < slotCount; ++i) {
+		SharedMeshRing::SlotHeader* slot = new (GetSlot(i)) SharedMeshRing::SlotHeader;
+		slot->mGeneration.store(0, std::memory_order_relaxed);
+		slot->mVertexCount = 0;
+		slot->mIndexCount = 0;
+	}
+
+	// Consumers may open the segment as soon as it has a name, so mark it valid last.
+	mHeader->mMagic.store(SharedMeshRing::Magic, std::memory_order_release);
+	return true;
+}
+
+// Remove the ring.
+void SharedMeshPublisher::Close()
+{
+	mMemory.Close();
+	mHeader = nullptr;
+	mSlot = nullptr;
+	mVertices = nullptr;
+	mIndices = nullptr;
+	mVertexCount = 0;
+	mIndexCount = 0;
+	mVertexReserved = 0;
+	mIndexReserved = 0;
+}
+
+// Start writing a mesh into the next slot.
+bool SharedMeshPublisher::BeginMesh(U32 vertexCount, U32 indexCount)
+{
+	assert(mHeader != nullptr);
+	assert(mSlot == nullptr);
+	if ((vertexCount > mHeader->mVertexCapacity) || (indexCount > mHeader->mIndexCapacity)) {
+		return false;
+	}
+	if (!CanPublish()) {
+		return false;
+	}
+
+	// Mark the slot as being written before touching its data.
+	const U64 head = mHeader->mHead.load(std::memory_order_relaxed);
+	mSlot = GetSlot(head);
+	mSlot->mGeneration.store(GetWritingGeneration(head), std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	mVertices = GetSlotVertices(mSlot);
+	mIndices = GetSlotIndices(mSlot, mHeader->mVertexCapacity);
+	mVertexCount = 0;
+	mIndexCount = 0;
+	mVertexReserved = vertexCount;
+	mIndexReserved = indexCount;
+	return true;
+}
+
+// Make the current mesh visible to the consumer.
+U64 SharedMeshPublisher::PublishMesh()
+{
+	assert(mSlot != nullptr);
+	const U64 head = mHeader->mHead.load(std::memory_order_relaxed);
+	mSlot->mVertexCount = mVertexCount;
+	mSlot->mIndexCount = mIndexCount;
+	mSlot->mGeneration.store(GetPublishedGeneration(head), std::memory_order_release);
+	mHeader->mHead.store(head + 1, std::memory_order_release);
+
+	mSlot = nullptr;
+	mVertices = nullptr;
+	mIndices = nullptr;
+	mVertexReserved = 0;
+	mIndexReserved = 0;
+	return head;
+}
+
+// Check whether a slot is free for the next mesh.
+bool SharedMeshPublisher::CanPublish() const
+{
+	assert(mHeader != nullptr);
+	const U64 head = mHeader->mHead.load(std::memory_order_relaxed);
+	const U64 tail = mHeader->mTail.load(std::memory_order_acquire);
+	return ((head - tail) < mHeader->mSlotCount);
+}
+
+// Get a slot's header by sequence number.
+SharedMeshRing::SlotHeader* SharedMeshPublisher::GetSlot(U64 sequence) const
+{
+	char* slots = static_cast<char*>(mMemory.GetData()) + AlignToCacheLine(sizeof(SharedMeshRing::Header));
+	const size_t slotIndex = static_cast<size_t>(sequence % mHeader->mSlotCount);
+	return reinterpret_cast<SharedMeshRing::SlotHeader*>(slots + (slotIndex * mHeader->mSlotByteSize));
+}
+
+SharedMeshConsumer::SharedMeshConsumer()
+	: mHeader(nullptr)
+	, mSlotCount(0)
+	, mVertexCapacity(0)
+	, mIndexCapacity(0)
+	, mSlotByteSize(0)
+{
+}
+
+// Map a ring created by a publisher and check its layout.
+bool SharedMeshConsumer::Open(const std::string& name)
+{
+	Close();
+	if (!mMemory.Open(name)) {
+		return false;
+	}
+
+	// Reject segments that aren't fully set up or don't match this layout.
+	const size_t mappedByteSize = mMemory.GetByteSize();
+	const size_t headerByteSize = AlignToCacheLine(sizeof(SharedMeshRing::Header));
+	SharedMeshRing::Header* header = static_cast<SharedMeshRing::Header*>(mMemory.GetData());
+	bool valid = (mappedByteSize >= headerByteSize) && SharedMeshRing::IsLockFree(*header);
+	if (valid) {
+		valid = (header->mMagic.load(std::memory_order_acquire) == SharedMeshRing::Magic) &&
+			(header->mVersion == SharedMeshRing::Version);
+	}
+
+	// Copy the layout once, so a producer changing it later can't move reads outside the mapping.
+	U32 slotCount = 0;
+	U32 vertexCapacity = 0;
+	U32 indexCapacity = 0;
+	U64 slotByteSize = 0;
+	if (valid) {
+		slotCount = header->mSlotCount;
+		vertexCapacity = header->mVertexCapacity;
+		indexCapacity = header->mIndexCapacity;
+		slotByteSize = header->mSlotByteSize;
+		valid = (slotCount != 0) &&
+			(slotByteSize == SharedMeshRing::CalculateSlotByteSize(vertexCapacity, indexCapacity)) &&
+			(slotCount <= ((mappedByteSize - headerByteSize) / slotByteSize));
+	}
+	if (!valid) {
+		mMemory.Close();
+		return false;
+	}
+
+	mHeader = header;
+	mSlotCount = slotCount;
+	mVertexCapacity = vertexCapacity;
+	mIndexCapacity = indexCapacity;
+	mSlotByteSize = static_cast<size_t>(slotByteSize);
+	return true;
+}
+
+// Unmap the ring.
+void SharedMeshConsumer::Close()
+{
+	mMemory.Close();
+	mHeader = nullptr;
+	mSlotCount = 0;
+	mVertexCapacity = 0;
+	mIndexCapacity = 0;
+	mSlotByteSize = 0;
+}
+
+// Get the oldest published mesh that hasn't been released.
+bool SharedMeshConsumer::Acquire(SharedMeshView& view) const
+{
+	assert(mHeader != nullptr);
+	const U64 tail = mHeader->mTail.load(std::memory_order_relaxed);
+	const U64 head = mHeader->mHead.load(std::memory_order_acquire);
+	if (tail == head) {
+		return false;
+	}
+
+	// The producer can't reuse this slot until it's released, so the data can be read in place.
+	const SharedMeshRing::SlotHeader* slot = GetSlot(tail);
+	const U64 generation = slot->mGeneration.load(std::memory_order_acquire);
+	if (generation != GetPublishedGeneration(tail)) {
+		return false;
+	}
+
+	// Counts come from the other process, so never hand out more than a slot holds.
+	const U32 vertexCount = slot->mVertexCount;
+	const U32 indexCount = slot->mIndexCount;
+	if ((vertexCount > mVertexCapacity) || (indexCount > mIndexCapacity)) {
+		return false;
+	}
+
+	view.mVertices = GetSlotVertices(slot);
+	view.mVertexCount = vertexCount;
+	view.mIndices = GetSlotIndices(slot, mVertexCapacity);
+	view.mIndexCount = indexCount;
+	view.mSequence = tail;
+	view.mGeneration = generation;
+	return true;
+}
+
+// Release the oldest acquired mesh so its slot can be reused.
+void SharedMeshConsumer::Release(const SharedMeshView& view)
+{
+	assert(mHeader != nullptr);
+	const U64 tail = mHeader->mTail.load(std::memory_order_relaxed);
+	assert(view.mSequence == tail);
+	Unused(view);
+	mHeader->mTail.store(tail + 1, std::memory_order_release);
+}
+
+// Check that a view's slot still holds the mesh it was acquired with.
+bool SharedMeshConsumer::IsValid(const SharedMeshView& view) const
+{
+	assert(mHeader != nullptr);
+	const SharedMeshRing::SlotHeader* slot = GetSlot(view.mSequence);
+	return (slot->mGeneration.load(std::memory_order_acquire) == view.mGeneration);
+}
+
+// Get a slot's header by sequence number.
+const SharedMeshRing::SlotHeader* SharedMeshConsumer::GetSlot(U64 sequence) const
+{
+	const char* slots = static_cast<const char*>(mMemory.GetData()) + AlignToCacheLine(sizeof(SharedMeshRing::Header));
+	const size_t slotIndex = static_cast<size_t>(sequence % mSlotCount);
+	return reinterpret_cast<const SharedMeshRing::SlotHeader*>(slots + (slotIndex * mSlotByteSize));
+}
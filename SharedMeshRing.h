@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Common.h"
+#include "SharedMemory.h"
+#include <atomic>
+#include <cassert>
+#include <string>
+
+// Layout of a ring of mesh slots in shared memory, written by one producer process and read by one consumer process.
+// Meshes are written straight into a slot and read in place, so handing one over copies nothing.
+namespace SharedMeshRing
+{
+	// Identifies a valid ring segment.
+	static constexpr U32 Magic = 0x4A4D5247U;
+	static constexpr U32 Version = 1U;
+
+	// Keep counters touched by different processes on separate cache lines.
+	static constexpr size_t CacheLineSize = 64;
+
+	// Ring header at the start of the segment.
+	struct Header
+	{
+		std::atomic<U32> mMagic; // Stored last by the producer once the header is valid.
+		U32 mVersion;
+		U32 mSlotCount;
+		U32 mVertexCapacity;
+		U32 mIndexCapacity;
+		U64 mSlotByteSize;
+
+		// Number of meshes published; only written by the producer.
+		alignas(CacheLineSize) std::atomic<U64> mHead;
+
+		// Number of meshes released; only written by the consumer.
+		alignas(CacheLineSize) std::atomic<U64> mTail;
+	};
+
+	// Header at the start of each slot, followed by vertices and then indices.
+	// The generation is odd while the slot is being written and even once published.
+	// Publishing mesh number n leaves the generation at 2n + 2, so readers can tell which mesh a slot holds.
+	struct SlotHeader
+	{
+		std::atomic<U64> mGeneration;
+		U32 mVertexCount;
+		U32 mIndexCount;
+	};
+
+	// Get the number of bytes for one slot.
+	size_t CalculateSlotByteSize(U32 vertexCapacity, U32 indexCapacity);
+
+	// Get the number of bytes for a whole ring segment.
+	size_t CalculateByteSize(U32 slotCount, U32 vertexCapacity, U32 indexCapacity);
+
+	// Check that the header's counters are lock free, so they work across processes.
+	bool IsLockFree(const Header& header);
+}
+
+// Mesh published to a shared ring, read in place by the consumer.
+struct SharedMeshView
+{
+	const Vector3* mVertices;
+	U32 mVertexCount;
+	const U32* mIndices;
+	U32 mIndexCount;
+	U64 mSequence; // Publish order of this mesh.
+	U64 mGeneration; // Slot generation when the mesh was acquired.
+};
+
+// Producer side of a shared mesh ring.
+// Meshes are written vertex by vertex with the same interface as Mesh3, then published at once.
+class SharedMeshPublisher
+{
+public:
+	SharedMeshPublisher();
+	~SharedMeshPublisher() = default;
+
+	// Create a named ring with a fixed number of slots, each holding a mesh up to the given capacities.
+	// Fails if the platform's atomics can't be shared between processes.
+	bool Create(const std::string& name, U32 slotCount, U32 vertexCapacity, U32 indexCapacity);
+
+	// Remove the ring.
+	void Close();
+
+	// Start writing a mesh into the next slot.
+	// Fails if the consumer still holds every slot or the mesh doesn't fit a slot.
+	bool BeginMesh(U32 vertexCount, U32 indexCount);
+
+	// Write the next vertex of the current mesh.
+	inline void AddVertex(const Vector3& vertex)
+	{
+		assert(mVertexCount < mVertexReserved);
+		mVertices[mVertexCount++] = vertex;
+	}
+
+	// Write the next index of the current mesh.
+	inline void AddIndex(U32 index)
+	{
+		assert(mIndexCount < mIndexReserved);
+		mIndices[mIndexCount++] = index;
+	}
+
+	// Make the current mesh visible to the consumer.
+	// Returns the mesh's sequence number.
+	U64 PublishMesh();
+
+	// Check whether a slot is free for the next mesh.
+	bool CanPublish() const;
+
+	// Check whether the ring was created.
+	inline bool IsOpen() const
+	{
+		return mMemory.IsOpen();
+	}
+
+private:
+	// Get a slot's header by index.
+	SharedMeshRing::SlotHeader* GetSlot(U64 sequence) const;
+
+private:
+	SharedMemory mMemory;
+	SharedMeshRing::Header* mHeader;
+
+	// Mesh currently being written.
+	SharedMeshRing::SlotHeader* mSlot;
+	Vector3* mVertices;
+	U32* mIndices;
+	U32 mVertexCount;
+	U32 mIndexCount;
+	U32 mVertexReserved;
+	U32 mIndexReserved;
+};
+
+// Consumer side of a shared mesh ring.
+// Acquired meshes stay valid and unchanged until they're released.
+class SharedMeshConsumer
+{
+public:
+	SharedMeshConsumer();
+	~SharedMeshConsumer() = default;
+
+	// Map a ring created by a publisher.
+	// Fails if the segment's layout doesn't match its size or the platform's atomics can't be shared between processes.
+	bool Open(const std::string& name);
+
+	// Unmap the ring.
+	void Close();
+
+	// Get the oldest published mesh that hasn't been released.
+	// Returns false if there's nothing new to read, or the slot claims more than its capacity.
+	bool Acquire(SharedMeshView& view) const;
+
+	// Release the oldest acquired mesh so its slot can be reused.
+	void Release(const SharedMeshView& view);
+
+	// Check that a view's slot still holds the mesh it was acquired with.
+	bool IsValid(const SharedMeshView& view) const;
+
+	// Check whether the ring is mapped.
+	inline bool IsOpen() const
+	{
+		return mMemory.IsOpen();
+	}
+
+private:
+	// Get a slot's header by index.
+	const SharedMeshRing::SlotHeader* GetSlot(U64 sequence) const;
+
+private:
+	SharedMemory mMemory;
+	SharedMeshRing::Header* mHeader;
+
+	// Layout checked when opening; the shared header isn't trusted for addressing after that.
+	U32 mSlotCount;
+	U32 mVertexCapacity;
+	U32 mIndexCapacity;
+	size_t mSlotByteSize;
+};